@@ -0,0 +1,164 @@
+#!/usr/bin/env python
+import filecmp
+import os
+import shutil
+import sys
+import subprocess
+import time
+
+# Runs every benchmark input with each cutting strategy, reports the run times
+# and checks that all strategies produce the same result as the serial one.
+# A run split into partitions by partition.py has to produce the same result as well,
+# and so does a delta output expanded with --expand.
+# Then every benchmark input is compiled into an empty capsule cache and cut again with a moved stock,
+# which has to hit the cache and produce the same result as a run without cache.
+# Afterwards every command file in benchmark/stream is fed to the streaming mode
+# and the reported per move latency percentiles are printed.
+# Finally the arc heavy programs in benchmark/locality and test002 are cut with
+# every column layout, to compare the cutting time and the page faults and TLB misses.
+# Usage: benchmark.py [build_dir]
+
+strategies = [
+    ('serial', []),
+    ('segment-parallel', ['--segment-threads', '0']),
+    ('huge-pages', ['--segment-threads', '0', '--huge-pages', 'transparent']),
+]
+
+partition_count = 7
+
+layouts = ['linear', 'tiled']
+
+project_folder = os.path.dirname(__file__)
+build_dir = os.path.join(project_folder, 'build') if len(sys.argv) < 2 else os.path.abspath(sys.argv[1])
+config = 'Release'
+
+if sys.platform == "win32":
+    exe_candidates = [os.path.join(build_dir, config, 'cutSphereMove.exe'), os.path.join(build_dir, 'cutSphereMove.exe')]
+else:
+    exe_candidates = [os.path.join(build_dir, 'cutSphereMove')]
+
+cutSphereMoveExecutable = None
+for candidate in exe_candidates:
+    if os.path.isfile(candidate):
+        cutSphereMoveExecutable = candidate
+
+if cutSphereMoveExecutable is None:
+    print('ERROR: Cannot find cutSphereMove, did you forget to build?')
+    sys.exit(1)
+
+benchmark_output_dir = os.path.join(build_dir, 'benchmark_output')
+os.makedirs(benchmark_output_dir, exist_ok=True)
+rc = 0
+for benchmark in sorted(os.listdir(os.path.join(project_folder, 'benchmark', 'input'))):
+    print(''.join(['-']*80))
+    print('Benchmark: ' + benchmark)
+    benchmark_input_path = os.path.join(project_folder, 'benchmark', 'input', benchmark)
+    reference_output_path = None
+    partitioned_output_path = os.path.join(benchmark_output_dir, 'partitioned_' + benchmark)
+    delta_path = os.path.join(benchmark_output_dir, 'delta_' + benchmark)
+    expanded_output_path = os.path.join(benchmark_output_dir, 'expanded_' + benchmark)
+    # Every run is a list of commands, the last one writes the output to compare
+    runs = [(name, [[cutSphereMoveExecutable, benchmark_input_path, os.path.join(benchmark_output_dir, name + '_' + benchmark)] + args],
+             os.path.join(benchmark_output_dir, name + '_' + benchmark), None) for name, args in strategies]
+    runs.append(('partitioned', [[sys.executable, os.path.join(project_folder, 'partition.py'), benchmark_input_path,
+                                  partitioned_output_path, str(partition_count), build_dir]], partitioned_output_path, subprocess.DEVNULL))
+    runs.append(('delta-expanded', [[cutSphereMoveExecutable, benchmark_input_path, delta_path, '--delta'],
+                                    [cutSphereMoveExecutable, '--expand', delta_path, expanded_output_path]], expanded_output_path, None))
+    for name, cmds, benchmark_output_path, stdout in runs:
+        start = time.time()
+        if any(subprocess.call(cmd, stdout=stdout) != 0 for cmd in cmds):
+            print('ERROR: ' + name + ' failed')
+            rc = 1
+            continue
+        end = time.time()
+
+        if reference_output_path is None:
+            reference_output_path = benchmark_output_path
+            status = 'reference'
+        elif filecmp.cmp(reference_output_path, benchmark_output_path, shallow=False):
+            status = 'same result'
+        else:
+            status = 'DIFFERENT RESULT'
+            rc = 1
+        print('{:<20} {:>10.3f}s  {}'.format(name, end - start, status))
+print(''.join(['-']*80))
+
+cache_dir = os.path.join(build_dir, 'benchmark_cache')
+shutil.rmtree(cache_dir, ignore_errors=True)
+for benchmark in sorted(os.listdir(os.path.join(project_folder, 'benchmark', 'input'))):
+    print('Cache: ' + benchmark)
+    benchmark_input_path = os.path.join(project_folder, 'benchmark', 'input', benchmark)
+
+    # The cache key ignores the cloud line, so the moved stock shares the entry of the original program
+    moved_input_path = os.path.join(benchmark_output_dir, 'moved_' + benchmark)
+    with open(benchmark_input_path, 'rt') as f, open(moved_input_path, 'wt') as moved:
+        for line in f:
+            values = line.split('#')[0].split()
+            if values and values[0] == 'cloud':
+                line = 'cloud {} {} {} {} {} {} {}\n'.format(float(values[1]) + 7.5, float(values[2]) - 3.0, values[3],
+                                                          int(values[4]) - 20, values[5], values[6], values[7])
+            moved.write(line)
+
+    cache_runs = [
+        ('cold', benchmark_input_path, ['--cache', cache_dir], os.path.join(benchmark_output_dir, 'serial_' + benchmark)),
+        ('moved-stock', moved_input_path, [], None),
+        ('moved-stock-cached', moved_input_path, ['--cache', cache_dir], os.path.join(benchmark_output_dir, 'moved-stock_' + benchmark)),
+    ]
+    for name, input_path, args, reference_output_path in cache_runs:
+        cache_output_path = os.path.join(benchmark_output_dir, name + '_' + benchmark)
+        entry_count = len(os.listdir(cache_dir)) if os.path.isdir(cache_dir) else 0
+        start = time.time()
+        if subprocess.call([cutSphereMoveExecutable, input_path, cache_output_path] + args) != 0:
+            print('ERROR: ' + name + ' failed')
+            rc = 1
+            continue
+        end = time.time()
+
+        if reference_output_path is None:
+            status = 'reference'
+        elif not filecmp.cmp(reference_output_path, cache_output_path, shallow=False):
+            status = 'DIFFERENT RESULT'
+            rc = 1
+        elif name == 'moved-stock-cached' and len(os.listdir(cache_dir)) != entry_count:
+            status = 'CACHE MISS'
+            rc = 1
+        else:
+            status = 'same result'
+        print('{:<20} {:>10.3f}s  {}'.format(name, end - start, status))
+    print(''.join(['-']*80))
+
+for stream in sorted(os.listdir(os.path.join(project_folder, 'benchmark', 'stream'))):
+    print('Stream: ' + stream)
+    with open(os.path.join(project_folder, 'benchmark', 'stream', stream), 'rt') as f:
+        stream_output = subprocess.run([cutSphereMoveExecutable, '--stream'], stdin=f, stdout=subprocess.PIPE, universal_newlines=True).stdout
+    errors = [line for line in stream_output.splitlines() if line.startswith('std::exception')]
+    for error in errors:
+        print('ERROR: ' + error)
+        rc = 1
+    print(stream_output.splitlines()[-1])
+    print(''.join(['-']*80))
+locality_inputs = [os.path.join(project_folder, 'benchmark', 'locality', name) for name in sorted(os.listdir(os.path.join(project_folder, 'benchmark', 'locality')))]
+locality_inputs.append(os.path.join(project_folder, 'tests', 'input', 'test002_arc.txt'))
+for locality_input_path in locality_inputs:
+    print('Locality: ' + os.path.basename(locality_input_path))
+    reference_output_path = None
+    for layout in layouts:
+        locality_output_path = os.path.join(benchmark_output_dir, layout + '_' + os.path.basename(locality_input_path))
+        locality_output = subprocess.run([cutSphereMoveExecutable, locality_input_path, locality_output_path, '--layout', layout, '--perf'],
+                                         stdout=subprocess.PIPE, universal_newlines=True)
+        if locality_output.returncode != 0:
+            print('ERROR: ' + layout + ' failed')
+            rc = 1
+            continue
+
+        if reference_output_path is None:
+            reference_output_path = locality_output_path
+            status = 'reference'
+        elif filecmp.cmp(reference_output_path, locality_output_path, shallow=False):
+            status = 'same result'
+        else:
+            status = 'DIFFERENT RESULT'
+            rc = 1
+        print('{:<20} {}  {}'.format(layout, ', '.join(locality_output.stdout.splitlines()), status))
+    print(''.join(['-']*80))
+sys.exit(rc)
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "geo/Curve.hpp"
+#include "geo/Point3.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace geo
+{
+    /// Invariants of a single capsule, unpacked once before testing the points against it
+    struct Capsule
+    {
+        Point3D startPoint;
+        Point3D endPoint;
+        Point3D axis;
+        double startDotAxis;
+        double inverseAxisLength2;
+        bool hasStartSphere;
+        std::uint32_t tool;
+        double sphereRadiusSquared;
+    };
+
+    /// Number of capsules eliminated by CapsuleList::Simplify and CapsuleList::Cull
+    struct SimplifyStatistics
+    {
+        size_t inputCount = 0;
+        size_t outputCount = 0;
+        size_t mergedCount = 0;
+        size_t zeroLengthCount = 0;
+        size_t aboveStockCount = 0;
+        size_t outsideCloudCount = 0;
+    };
+
+    /// Compiled sphere path, every step of the path is swept by the sphere as a capsule
+    /// @note stored as structure of arrays with all per capsule invariants precomputed
+    struct CapsuleList
+    {
+        std::uint32_t AddTool(const double sphereRadius);
+        void AddCurve(const Curve& curve, const double deltaT, const std::uint32_t tool);
+        void Add(const Point3D& startPoint, const Point3D& endPoint, const bool hasStartSphere, const std::uint32_t tool);
+        size_t Size() const;
+        SimplifyStatistics Simplify(const bool isMergingCollinear);
+        void Cull(const Point3D& cloudMinPoint, const Point3D& cloudMaxPoint, SimplifyStatistics& statistics);
+
+        Capsule Get(const size_t i) const;
+
+        // Sphere radius and its square per tool, a tool is added on every tool change
+        std::vector<double> toolRadius;
+        std::vector<double> toolRadiusSquared;
+
+        // Sphere centers at start and end of the step
+        std::vector<double> startX, startY, startZ;
+        std::vector<double> endX, endY, endZ;
+
+        // Cylinder axis, 1 / (axis * axis) and startPoint * axis
+        std::vector<double> axisX, axisY, axisZ;
+        std::vector<double> inverseAxisLength2;
+        std::vector<double> startDotAxis;
+
+        // Bounding box of the capsule including the sphere radius
+        std::vector<double> minX, maxX, minY, maxY, minZ, maxZ;
+
+        // Sphere at the start point is only needed for the first step of a curve
+        std::vector<std::uint8_t> hasStartSphere;
+
+        // Index of the tool, that sweeps the capsule
+        std::vector<std::uint32_t> tool;
+    };
+}
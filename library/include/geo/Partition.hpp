@@ -0,0 +1,24 @@
+#pragma once
+
+#include "geo/Point3.hpp"
+
+#include <string>
+
+namespace geo
+{
+    class Partition
+    {
+    public: Partition(
+        const int index,
+        const int count);
+
+        static Partition Parse(const std::string& spec);
+
+        int GetFirstColumn(const int nx) const;
+        int GetColumnCount(const int nx) const;
+        Point3D GetReferencePoint(const Point3D& refPoint, const int nx, const double deltaS) const;
+    private:
+        int m_index;
+        int m_count;
+    };
+}
@@ -1,12 +1,26 @@
 ﻿#pragma once
 
+#include "geo/CapsuleList.hpp"
 #include "geo/Curve.hpp"
 #include "geo/Point3.hpp"
+#include "mem/CloudBuffer.hpp"
 
 #include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
 
 namespace geo
 {
+    /// Order of the columns in the cloud storage
+    enum class ColumnLayout
+    {
+        /// x major then y, as in the output
+        Linear,
+        /// small square tiles of columns, so a tool footprint covers few memory pages
+        Tiled
+    };
+
     class PointCloud
     {
     public: PointCloud(
@@ -14,19 +28,48 @@ namespace geo
         const int nx,
         const int ny,
         const int nz,
-        const double deltaS);
+        const double deltaS,
+        const ColumnLayout layout = ColumnLayout::Linear,
+        const mem::AllocationPolicy& policy = mem::AllocationPolicy());
+
+        static ColumnLayout ParseColumnLayout(const std::string& name);
+
+        mem::HugePages GetHugePages() const;
+        bool IsInterleaved() const;
+        bool IsPinned() const;
+
+        Point3D GetMinPoint() const;
+        Point3D GetMaxPoint() const;
 
         void RemovePointsOnSpherePath(const double sphereRadius, const Curve& curve, const double deltaT);
+        void RemovePointsInCapsules(const CapsuleList& capsules);
+        void RemovePointsInCapsulesParallel(const CapsuleList& capsules, unsigned int threadCount);
+        bool GetTopPoint(const double x, const double y, Point3D& topPoint) const;
         void CalculatePointsOnTopAndSaveToFile(const std::filesystem::path& outputFileName) const;
+        void CalculateChangedColumnsAndSaveToFile(const std::filesystem::path& outputFileName) const;
     private:
+        size_t GetColumnIndex(const int ix, const int iy) const;
+        Point3D* GetColumn(const size_t columnIndex) const;
+        template <class Function>
+        void ForEachTopPoint(Function function) const;
+        bool GetColumnRange(const CapsuleList& capsules, const size_t i, int& ixFirst, int& ixLast, int& iyFirst, int& iyLast) const;
+        bool GetIndexRange(const double minValue, const double maxValue, const double refValue, const int count, int& first, int& last) const;
         static bool IsPointInSphere(const Point3D point, const Point3D sphereCenter, const double sphereRadiusSquared);
-        static bool IsPointInCylinder(const Point3D point, const Point3D bottomPoint, const Point3D axis, const double sphereRadiusSquared);
+        static bool IsPointInCapsule(const Point3D point, const Capsule& capsule);
+        static bool IsPointInCylinder(const Point3D point, const Point3D bottomPoint, const Point3D axis, const double bottomDotAxis, const double inverseAxisLength2, const double sphereRadiusSquared);
         
         const Point3D m_refPoint;
         const int m_nx;
         const int m_ny;
         const int m_nz;
         const double m_deltaS;
-        std::vector<std::vector<std::vector<Point3D>>> m_pointCloud;
+        const ColumnLayout m_layout;
+        const int m_tileCountY;
+        const unsigned int m_threadCount;
+        bool m_isPinned;
+        const mem::AllocationPolicy m_allocationPolicy;
+        std::unique_ptr<mem::CloudBuffer> m_buffer;
+        Point3D* m_points;
+        std::vector<int> m_columnSizes;
     };
 }
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "geo/CapsuleList.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+
+namespace io
+{
+/// On-disk cache of compiled sphere paths
+class CapsuleCache
+{
+public:
+	CapsuleCache(
+		const std::filesystem::path& cacheDirectory,
+		const std::filesystem::path& testFile,
+		const bool isMergingCollinear);
+
+	const std::vector<std::string>& GetSettingLines() const;
+
+	bool Load(geo::CapsuleList& capsules, geo::SimplifyStatistics& statistics) const;
+
+	bool Save(const geo::CapsuleList& capsules, const geo::SimplifyStatistics& statistics) const;
+
+private:
+	std::uint64_t m_key;
+	std::filesystem::path m_cacheDirectory;
+	std::filesystem::path m_cacheFile;
+	std::vector<std::string> m_settingLines;
+};
+}  // namespace io
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "geo/Point3.hpp"
+
+#include <cstdio>
+#include <filesystem>
+
+
+namespace io
+{
+/// Result file, that only contains the columns whose top point was changed by the cut
+///
+/// Format:
+///   stock refX refY refZ nx ny nz deltaS
+///   ix iy iz    # one line per changed column, iz is the new top index or -1 if the column is empty
+class DeltaOutput
+{
+public:
+	DeltaOutput(
+		const std::filesystem::path& f,
+		const geo::Point3D& refPoint,
+		const int nx,
+		const int ny,
+		const int nz,
+		const double deltaS);
+
+	~DeltaOutput();
+
+	void WriteColumn(const int ix, const int iy, const int iz) const;
+
+private:
+	FILE* m_fd;
+};
+
+void ExpandDeltaOutput(const std::filesystem::path& deltaFile, const std::filesystem::path& outputFile);
+}  // namespace io
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <filesystem>
+#include <vector>
+
+
+namespace io
+{
+void MergeOutputs(
+	const std::vector<std::filesystem::path>& partialOutputs,
+	const std::filesystem::path& outputFile);
+}  // namespace io
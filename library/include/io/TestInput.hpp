@@ -5,6 +5,8 @@
 #include "geo/Point3.hpp"
 
 #include <filesystem>
+#include <memory>
+#include <string>
 #include <vector>
 
 
@@ -12,8 +14,31 @@ namespace io
 {
 struct TestInput
 {
+	/// Move of the tool along a curve
+	struct Move
+	{
+		std::unique_ptr<geo::Curve> curve;
+		double sphereRadius;
+	};
+
+	enum class Command
+	{
+		Empty,
+		Cloud,
+		Delta,
+		Sphere,
+		Start,
+		Line,
+		Arc
+	};
+
+	/// Create empty input, that is filled line by line with ParseLine
+	TestInput();
+
 	TestInput(const std::filesystem::path& testFile);
 
+	Command ParseLine(std::string line);
+
 	geo::Point3D cloudReferencePoint = geo::Point3D(0., 0., 0.);
 	int cloudNX = 100;
 	int cloudNY = 100;
@@ -21,9 +46,14 @@ struct TestInput
 	double cloudDeltaS = 0.1;
 
 	double curveDeltaT = 0.1;
+	/// Radius of the current tool, a "sphere" command between moves changes the tool
 	double sphereRadius = 1.;
 
-	std::unique_ptr<geo::Curve> curve;
+	/// Position of the tool after the last move
+	geo::Point3D currentPoint = geo::Point3D(0., 0., 0.);
+
+	/// Moves of the program in the order of the input file
+	std::vector<Move> moves;
 };
 
 }  // namespace io
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace mem
+{
+    /// Page backing of the cloud storage
+    enum class HugePages
+    {
+        None,
+        Transparent,
+        Explicit
+    };
+
+    /// Allocation policy of the cloud storage
+    struct AllocationPolicy
+    {
+        HugePages hugePages = HugePages::None;
+
+        /// Interleave the pages across all NUMA nodes instead of placing them by first touch
+        bool isInterleaved = false;
+
+        /// Number of threads, that initialize the storage, 0 uses the number of hardware threads
+        /// @note pages are placed on the NUMA node of the thread that touches them first
+        unsigned int firstTouchThreadCount = 1;
+
+        static HugePages ParseHugePages(const std::string& name);
+    };
+
+    /// Uninitialized memory for the cloud points, allocated according to an AllocationPolicy
+    class CloudBuffer
+    {
+    public: CloudBuffer(
+        const size_t size,
+        const AllocationPolicy& policy);
+
+        ~CloudBuffer();
+        CloudBuffer(const CloudBuffer&) = delete;
+        CloudBuffer& operator=(const CloudBuffer&) = delete;
+
+        void* Data() const;
+        HugePages GetHugePages() const;
+        bool IsInterleaved() const;
+    private:
+        void* m_data;
+        size_t m_mappedSize;
+        HugePages m_hugePages;
+        bool m_isInterleaved;
+    };
+}
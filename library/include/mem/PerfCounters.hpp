@@ -0,0 +1,22 @@
+#pragma once
+
+#include <ostream>
+
+namespace mem
+{
+    /// Page fault and TLB miss counters of the process, counted from construction on
+    class PerfCounters
+    {
+    public: PerfCounters();
+
+        ~PerfCounters();
+        PerfCounters(const PerfCounters&) = delete;
+        PerfCounters& operator=(const PerfCounters&) = delete;
+
+        void Print(std::ostream& out) const;
+    private:
+        long m_minorFaults;
+        long m_majorFaults;
+        int m_tlbMissesFd;
+    };
+}
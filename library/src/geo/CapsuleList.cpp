@@ -0,0 +1,231 @@
+#include "geo/CapsuleList.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+namespace geo
+{
+    /// Adds a tool and precomputes its invariants once for all its capsules
+    ///
+    ///	@param sphereRadius radius R of the sphere
+    ///	@throws std::invalid_argument if sphereRadius is not greater than 0.
+    ///	@return index of the tool
+    std::uint32_t CapsuleList::AddTool(const double sphereRadius)
+    {
+        if(sphereRadius <= 0)
+        {
+            throw std::invalid_argument("Invalid argument for AddTool. sphereRadius has to be greater than 0.");
+        }
+
+        toolRadius.push_back(sphereRadius);
+        toolRadiusSquared.push_back(std::pow(sphereRadius,2));
+        return static_cast<std::uint32_t>(toolRadius.size() - 1);
+    }
+
+    /// Samples the curve and adds one capsule per step
+    /// @note Curve is linearly interpolated between steps, the last step is shortened,
+    /// so the path always ends at the end of the curve
+    /// 
+    ///	@param curve 3d curve that defines trajectory of the sphere
+    ///	@param deltaT step size for 3d curve parameter
+    ///	@param tool index of the tool, that moves along the curve
+    ///	@throws std::invalid_argument if deltaT is not greater than 0.
+    void CapsuleList::AddCurve(const Curve& curve, const double deltaT, const std::uint32_t tool)
+    {
+        if(deltaT <= 0 || deltaT > 1)
+        {
+            throw std::invalid_argument("Invalid argument for AddCurve. deltaT has to be greater than 0 and smaller than 1.");
+        } 
+        
+        double startTime = 0.0;
+        double endTime = deltaT;
+        Point3D sphereStartPoint = curve.Evaluate(startTime);
+        
+        while(endTime <= 1.0)
+        {
+            Point3D sphereEndPoint = curve.Evaluate(endTime);
+            Add(sphereStartPoint, sphereEndPoint, startTime <= 0, tool);
+
+            // Go to next point
+            startTime = endTime;
+            sphereStartPoint = sphereEndPoint;
+            
+            // Increase and correct next step in case it overshoots
+            endTime += deltaT;
+            if(startTime < 1.0 && endTime > 1.0)
+            {
+                endTime = 1.0;
+            }
+        }
+    }
+
+    /// Adds the capsule of one step and precomputes its invariants
+    /// 
+    ///	@param startPoint sphere center at the start of the step
+    ///	@param endPoint sphere center at the end of the step
+    ///	@param hasStartSphere true, if the sphere at the start point has to be removed as well
+    ///	@param tool index of the tool, that sweeps the capsule
+    void CapsuleList::Add(const Point3D& startPoint, const Point3D& endPoint, const bool hasStartSphere, const std::uint32_t tool)
+    {
+        const Point3D axis = endPoint - startPoint;
+        const double sphereRadius = toolRadius[tool];
+
+        startX.push_back(startPoint.x());
+        startY.push_back(startPoint.y());
+        startZ.push_back(startPoint.z());
+        endX.push_back(endPoint.x());
+        endY.push_back(endPoint.y());
+        endZ.push_back(endPoint.z());
+        axisX.push_back(axis.x());
+        axisY.push_back(axis.y());
+        axisZ.push_back(axis.z());
+        inverseAxisLength2.push_back(1.0 / (axis * axis));
+        startDotAxis.push_back(startPoint * axis);
+        minX.push_back(std::min(startPoint.x(), endPoint.x()) - sphereRadius);
+        maxX.push_back(std::max(startPoint.x(), endPoint.x()) + sphereRadius);
+        minY.push_back(std::min(startPoint.y(), endPoint.y()) - sphereRadius);
+        maxY.push_back(std::max(startPoint.y(), endPoint.y()) + sphereRadius);
+        minZ.push_back(std::min(startPoint.z(), endPoint.z()) - sphereRadius);
+        maxZ.push_back(std::max(startPoint.z(), endPoint.z()) + sphereRadius);
+        this->hasStartSphere.push_back(hasStartSphere ? 1 : 0);
+        this->tool.push_back(tool);
+    }
+
+    /// @return number of capsules
+    size_t CapsuleList::Size() const
+    {
+        return startX.size();
+    }
+
+    /// Removes capsules, that cannot remove additional points from any cloud
+    /// - zero length steps are dropped, if their sphere is already removed by a neighboring capsule
+    /// - collinear consecutive capsules are merged into one capsule, if requested
+    /// @note independent of the cloud, so all partitions of a cloud cut the same capsules.
+    /// Dropping zero length steps does not change the result, merging may round points exactly on the
+    /// surface of a capsule to the other side
+    /// 
+    ///	@param isMergingCollinear true, if collinear consecutive capsules are merged
+    ///	@return number of eliminated capsules per reason
+    SimplifyStatistics CapsuleList::Simplify(const bool isMergingCollinear)
+    {
+        // Relative tolerance of the sine of the angle between two capsule axes to count as collinear
+        static constexpr double collinearTolerance = 1e-12;
+
+        SimplifyStatistics statistics;
+        statistics.inputCount = Size();
+
+        CapsuleList simplified;
+        simplified.toolRadius = toolRadius;
+        simplified.toolRadiusSquared = toolRadiusSquared;
+        bool hasPending = false;
+        Capsule pending {};
+        bool hasCarriedStartSphere = false;
+        for (size_t i = 0; i < Size(); i++)
+        {
+            Capsule capsule = Get(i);
+            capsule.hasStartSphere = capsule.hasStartSphere || hasCarriedStartSphere;
+            hasCarriedStartSphere = false;
+
+            // A zero length step only removes the sphere at its end point, which is either
+            // already removed by the previous capsule or handed over as start sphere to the next one,
+            // as long as their tool is not smaller
+            if(capsule.startPoint == capsule.endPoint)
+            {
+                if(hasPending && pending.endPoint == capsule.endPoint
+                    && toolRadius[pending.tool] >= toolRadius[capsule.tool])
+                {
+                    statistics.zeroLengthCount++;
+                    continue;
+                }
+                if(i + 1 < Size() && Point3D(startX[i + 1], startY[i + 1], startZ[i + 1]) == capsule.endPoint
+                    && toolRadius[tool[i + 1]] >= toolRadius[capsule.tool])
+                {
+                    hasCarriedStartSphere = true;
+                    statistics.zeroLengthCount++;
+                    continue;
+                }
+            }
+
+            // The start sphere of a following collinear capsule of the same tool in the same direction
+            // is inside the merged capsule, so it just extends the pending capsule
+            if(isMergingCollinear && hasPending && pending.endPoint == capsule.startPoint && pending.tool == capsule.tool)
+            {
+                const Point3D cross = pending.axis % capsule.axis;
+                if(pending.axis * capsule.axis > 0
+                    && cross.Length2() <= collinearTolerance * collinearTolerance * pending.axis.Length2() * capsule.axis.Length2())
+                {
+                    pending.endPoint = capsule.endPoint;
+                    statistics.mergedCount++;
+                    continue;
+                }
+            }
+
+            if(hasPending)
+            {
+                simplified.Add(pending.startPoint, pending.endPoint, pending.hasStartSphere, pending.tool);
+            }
+            pending = capsule;
+            hasPending = true;
+        }
+
+        if(hasPending)
+        {
+            simplified.Add(pending.startPoint, pending.endPoint, pending.hasStartSphere, pending.tool);
+        }
+
+        statistics.outputCount = simplified.Size();
+        *this = std::move(simplified);
+        return statistics;
+    }
+
+    /// Removes capsules, that cannot remove any point from the given cloud
+    /// - capsules completely above the stock top or outside the cloud are discarded
+    /// @note only whole capsules are discarded, the remaining ones are not changed
+    /// 
+    ///	@param cloudMinPoint point of the cloud with the minimum values along all coordinate axes
+    ///	@param cloudMaxPoint point of the cloud with the maximum values along all coordinate axes
+    ///	@param statistics number of eliminated capsules per reason, updated by the discarded capsules
+    void CapsuleList::Cull(const Point3D& cloudMinPoint, const Point3D& cloudMaxPoint, SimplifyStatistics& statistics)
+    {
+        CapsuleList culled;
+        culled.toolRadius = toolRadius;
+        culled.toolRadiusSquared = toolRadiusSquared;
+        for (size_t i = 0; i < Size(); i++)
+        {
+            if(minZ[i] > cloudMaxPoint.z())
+            {
+                statistics.aboveStockCount++;
+                continue;
+            }
+            if(maxX[i] < cloudMinPoint.x() || minX[i] > cloudMaxPoint.x()
+                || maxY[i] < cloudMinPoint.y() || minY[i] > cloudMaxPoint.y()
+                || maxZ[i] < cloudMinPoint.z())
+            {
+                statistics.outsideCloudCount++;
+                continue;
+            }
+
+            const Capsule capsule = Get(i);
+            culled.Add(capsule.startPoint, capsule.endPoint, capsule.hasStartSphere, capsule.tool);
+        }
+
+        statistics.outputCount = culled.Size();
+        *this = std::move(culled);
+    }
+
+    /// @return invariants of capsule i
+    Capsule CapsuleList::Get(const size_t i) const
+    {
+        return Capsule {
+            Point3D(startX[i], startY[i], startZ[i]),
+            Point3D(endX[i], endY[i], endZ[i]),
+            Point3D(axisX[i], axisY[i], axisZ[i]),
+            startDotAxis[i],
+            inverseAxisLength2[i],
+            hasStartSphere[i] != 0,
+            tool[i],
+            toolRadiusSquared[tool[i]]};
+    }
+}
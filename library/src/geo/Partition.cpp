@@ -0,0 +1,79 @@
+#include "geo/Partition.hpp"
+
+#include <sstream>
+#include <stdexcept>
+
+namespace geo
+{
+    /// Create Partition, which is a slab of the PointCloud grid along the x axis
+    ///
+    ///	@param index zero based index of the slab
+    ///	@param count number of slabs the grid is divided into
+    ///	@throws std::invalid_argument if count is not greater than 0 or index is not in [0, count)
+    Partition::Partition(
+        const int index,
+        const int count): m_index(index),
+        m_count(count)
+    {
+        if(count <= 0 || index < 0 || index >= count)
+        {
+            throw std::invalid_argument("Invalid argument for Partition Constructor. count has to be greater than 0 and index has to be in [0, count).");
+        }
+    }
+
+    /// Create Partition from a spec of the form "i/N"
+    ///
+    ///	@param spec partition spec, e.g. "0/4" for the first of four slabs
+    ///	@throws std::invalid_argument if the spec is malformed
+    Partition Partition::Parse(const std::string& spec)
+    {
+        std::istringstream iss(spec);
+        int index, count;
+        char separator;
+        if(!(iss >> index >> separator >> count) || separator != '/' || !iss.eof())
+        {
+            throw std::invalid_argument("invalid partition format! must be: \"i/N\".");
+        }
+
+        return Partition(index, count);
+    }
+
+    /// Calculate the first column along x that belongs to this slab
+    ///
+    ///	@param nx number of points in the full cloud along x axis
+    ///	@return index of the first column in the full cloud
+    int Partition::GetFirstColumn(const int nx) const
+    {
+        return static_cast<int>(static_cast<long long>(nx) * m_index / m_count);
+    }
+
+    /// Calculate the number of columns along x that belong to this slab
+    ///
+    ///	@param nx number of points in the full cloud along x axis
+    ///	@note slabs differ in size by at most one column, trailing slabs may be empty if count > nx
+    ///	@return number of columns of this slab
+    int Partition::GetColumnCount(const int nx) const
+    {
+        return static_cast<int>(static_cast<long long>(nx) * (m_index + 1) / m_count) - GetFirstColumn(nx);
+    }
+
+    /// Calculate the reference point of the sub cloud of this slab
+    ///
+    ///	@param refPoint reference point of the full cloud
+    ///	@param nx number of points in the full cloud along x axis
+    ///	@param deltaS distance between neighboring cloud points
+    ///	@note x is accumulated step by step like in the PointCloud constructor,
+    ///	so the slab points have the same coordinates as in the full cloud
+    ///	@return reference point of the slab
+    Point3D Partition::GetReferencePoint(const Point3D& refPoint, const int nx, const double deltaS) const
+    {
+        double x = refPoint.x();
+        const int firstColumn = GetFirstColumn(nx);
+        for (int ix = 0; ix < firstColumn; ix++)
+        {
+            x += deltaS;
+        }
+
+        return Point3D(x, refPoint.y(), refPoint.z());
+    }
+}
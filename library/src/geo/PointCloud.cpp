@@ -1,11 +1,116 @@
 ﻿#include "geo/PointCloud.hpp"
 
+#include "io/DeltaOutput.hpp"
 #include "io/TestOutput.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <new>
+#include <thread>
 #include <vector>
 
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 namespace geo
 {
+    namespace
+    {
+        /// Number of columns along x and y of a tile of the tiled layout
+        constexpr int tileSize = 8;
+
+        /// @return cpus the process may run on, read once from the affinity mask the process was started with
+        /// @note empty, if the mask is not available
+        const std::vector<int>& GetAllowedCpus()
+        {
+            static const std::vector<int> allowedCpus = []()
+            {
+                std::vector<int> cpus;
+#ifdef __linux__
+                cpu_set_t cpuSet;
+                CPU_ZERO(&cpuSet);
+                if(sched_getaffinity(0, sizeof(cpuSet), &cpuSet) == 0)
+                {
+                    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+                    {
+                        if(CPU_ISSET(cpu, &cpuSet))
+                        {
+                            cpus.push_back(cpu);
+                        }
+                    }
+                }
+#endif
+                return cpus;
+            }();
+            return allowedCpus;
+        }
+
+        /// @return threadCount, or the number of cpus the process may run on for 0
+        unsigned int GetThreadCount(const unsigned int threadCount)
+        {
+            if(threadCount != 0)
+            {
+                return threadCount;
+            }
+            if(!GetAllowedCpus().empty())
+            {
+                return static_cast<unsigned int>(GetAllowedCpus().size());
+            }
+            return std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        /// Run the function on one thread per slab of columns along x
+        /// @note slabs consist of whole rows of tiles, so every tile belongs to one slab. Slab i is always
+        /// processed by a thread pinned to the i-th cpu the process may run on, before it touches any page,
+        /// so the columns stay on the NUMA node of the thread that touched them first
+        /// @return false, if a thread could not be pinned
+        template <class Function>
+        bool RunOnColumnSlabs(const int nx, const ColumnLayout layout, const unsigned int threadCount, Function function)
+        {
+            if(threadCount == 1)
+            {
+                function(0, nx);
+                return true;
+            }
+
+            const int tileNX = layout == ColumnLayout::Tiled ? tileSize : 1;
+            const long long tileRowCount = (nx + tileNX - 1) / tileNX;
+            const std::vector<int>& allowedCpus = GetAllowedCpus();
+            std::atomic<bool> isPinned(!allowedCpus.empty());
+            std::vector<std::thread> threads;
+            for (unsigned int i = 0; i < threadCount; i++)
+            {
+                const int ixBegin = static_cast<int>(std::min<long long>(nx, tileRowCount * i / threadCount * tileNX));
+                const int ixEnd = static_cast<int>(std::min<long long>(nx, tileRowCount * (i + 1) / threadCount * tileNX));
+                threads.emplace_back([i, ixBegin, ixEnd, &allowedCpus, &isPinned, &function]()
+                {
+#ifdef __linux__
+                    if(!allowedCpus.empty())
+                    {
+                        cpu_set_t cpus;
+                        CPU_ZERO(&cpus);
+                        CPU_SET(allowedCpus[i % allowedCpus.size()], &cpus);
+                        if(pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) != 0)
+                        {
+                            isPinned = false;
+                        }
+                    }
+#endif
+                    function(ixBegin, ixEnd);
+                });
+            }
+            for (std::thread& thread : threads)
+            {
+                thread.join();
+            }
+            return isPinned;
+        }
+    }
+
     /// Create PointCloud
     ///
     ///	@param refPoint reference point O of the cloud, which is a point with the minimum values along
@@ -14,44 +119,130 @@ namespace geo
     ///	@param ny number of points in cloud along y axis
     ///	@param nz number of points in cloud along z axis
     ///	@param deltaS distance between neighboring cloud points along x, y and z axis
+    ///	@param layout order of the columns in the cloud storage
+    ///	@param policy allocation policy of the cloud storage
     ///	@throws std::invalid_argument if any of the parameters (nx, ny, nz or deltaS) are not greater than 0.
     PointCloud::PointCloud(
         const Point3D& refPoint,
         const int nx,
         const int ny,
         const int nz,
-        const double deltaS): m_refPoint(refPoint),
+        const double deltaS,
+        const ColumnLayout layout,
+        const mem::AllocationPolicy& policy): m_refPoint(refPoint),
         m_nx(nx),
         m_ny(ny),
         m_nz(nz),
-        m_deltaS(deltaS)
+        m_deltaS(deltaS),
+        m_layout(layout),
+        m_tileCountY((ny + tileSize - 1) / tileSize),
+        m_threadCount(GetThreadCount(policy.firstTouchThreadCount)),
+        m_isPinned(true),
+        m_allocationPolicy(policy)
     {
         if(nx <= 0 || ny <= 0 || nz <= 0 || deltaS <= 0)
         {
             throw std::invalid_argument("Invalid argument for PointCloud Constructor. nx, ny, nz and deltaS have to be greater than 0.");
         }
         
-        // Create PointCloud
-        m_pointCloud = std::vector(nx,std::vector(ny,std::vector<Point3D>(nz)));
+        // Create PointCloud, all points of a column are stored consecutively in one buffer.
+        // Partial tiles at the border are padded with empty columns
+        const size_t columnCount = layout == ColumnLayout::Tiled
+            ? static_cast<size_t>((nx + tileSize - 1) / tileSize) * m_tileCountY * tileSize * tileSize
+            : static_cast<size_t>(nx) * ny;
+        m_buffer = std::make_unique<mem::CloudBuffer>(columnCount * nz * sizeof(Point3D), policy);
+        m_points = static_cast<Point3D*>(m_buffer->Data());
+        m_columnSizes = std::vector<int>(columnCount, 0);
         
-        double x = refPoint.x();
-        for (int ix = 0; ix < m_nx; ix++)
+        // Every thread touches the pages of its own slab first
+        m_isPinned = RunOnColumnSlabs(m_nx, m_layout, m_threadCount, [&](const int ixBegin, const int ixEnd)
         {
-            double y = refPoint.y();
-            for (int iy = 0; iy < m_ny; iy++)
+            double x = refPoint.x();
+            for (int ix = 0; ix < ixBegin; ix++)
+            {
+                x += m_deltaS;
+            }
+
+            for (int ix = ixBegin; ix < ixEnd; ix++)
             {
-                double z = refPoint.z();
-                for (int iz = 0; iz < m_nz; iz++)
+                double y = refPoint.y();
+                for (int iy = 0; iy < m_ny; iy++)
                 {
-                    m_pointCloud[ix][iy][iz] = Point3D(x,y,z);
-                    z+= m_deltaS;
+                    const size_t columnIndex = GetColumnIndex(ix, iy);
+                    Point3D* column = GetColumn(columnIndex);
+                    m_columnSizes[columnIndex] = m_nz;
+                    double z = refPoint.z();
+                    for (int iz = 0; iz < m_nz; iz++)
+                    {
+                        new (&column[iz]) Point3D(x,y,z);
+                        z+= m_deltaS;
+                    }
+                    
+                    y+= m_deltaS;
                 }
                 
-                y+= m_deltaS;
+                x += m_deltaS;
             }
-            
-            x += m_deltaS;
+        });
+    }
+
+    /// Parse the name of a column layout
+    ///
+    ///	@param name "linear" or "tiled"
+    ///	@throws std::invalid_argument if the name is unknown
+    ColumnLayout PointCloud::ParseColumnLayout(const std::string& name)
+    {
+        if(name == "linear")
+        {
+            return ColumnLayout::Linear;
+        }
+        if(name == "tiled")
+        {
+            return ColumnLayout::Tiled;
         }
+
+        throw std::invalid_argument("invalid layout! must be: \"linear\" or \"tiled\".");
+    }
+
+    /// @return page backing of the cloud storage, that was actually achieved
+    mem::HugePages PointCloud::GetHugePages() const
+    {
+        return m_buffer->GetHugePages();
+    }
+
+    /// @return true, if the cloud storage is actually interleaved across the NUMA nodes
+    bool PointCloud::IsInterleaved() const
+    {
+        return m_buffer->IsInterleaved();
+    }
+
+    /// @return false, if a thread, that touched or compacted a slab of the cloud, could not be pinned to its cpu
+    bool PointCloud::IsPinned() const
+    {
+        return m_isPinned;
+    }
+
+    /// Calculate the lower corner of the bounding box of all cloud points
+    /// @note widened by half the point distance to be robust against rounding
+    ///
+    /// @return point with the minimum values along all coordinate axes
+    Point3D PointCloud::GetMinPoint() const
+    {
+        const double margin = m_deltaS / 2;
+        return Point3D(m_refPoint.x() - margin, m_refPoint.y() - margin, m_refPoint.z() - margin);
+    }
+
+    /// Calculate the upper corner of the bounding box of all cloud points, the z value is the stock top
+    /// @note widened by half the point distance to be robust against rounding
+    ///
+    /// @return point with the maximum values along all coordinate axes
+    Point3D PointCloud::GetMaxPoint() const
+    {
+        const double margin = m_deltaS / 2;
+        return Point3D(
+            m_refPoint.x() + (m_nx - 1) * m_deltaS + margin,
+            m_refPoint.y() + (m_ny - 1) * m_deltaS + margin,
+            m_refPoint.z() + (m_nz - 1) * m_deltaS + margin);
     }
 
     /// Removes all points on the trajectory of the sphere
@@ -66,57 +257,231 @@ namespace geo
             const Curve& curve,
             const double deltaT)
     {
-        if(deltaT <= 0 || deltaT > 1)
-        {
-            throw std::invalid_argument("Invalid argument for RemovePointsOnSpherePath. deltaT has to be greater than 0 and smaller than 1.");
-        } 
-        
-        double startTime = 0.0;
-        double endTime = deltaT;
-        Point3D sphereStartPoint = curve.Evaluate(startTime);
-        const double sphereRadiusSquared = std::pow(sphereRadius,2);
-        
-        // Iterate through time and through each point in the pointCloud
-        while(endTime <= 1.0)
+        CapsuleList capsules;
+        capsules.AddCurve(curve, deltaT, capsules.AddTool(sphereRadius));
+        RemovePointsInCapsules(capsules);
+    };
+
+    /// Removes all points inside the capsules of a compiled sphere path
+    /// 
+    ///	@param capsules compiled sphere path
+    void PointCloud::RemovePointsInCapsules(const CapsuleList& capsules)
+    {
+        // Iterate through steps and through each point in the pointCloud
+        for (size_t i = 0; i < capsules.Size(); i++)
         {
-            Point3D sphereEndPoint = curve.Evaluate(endTime);
-            const Point3D cylinderAxis = sphereEndPoint - sphereStartPoint;
+            // Only columns inside the bounding box of the capsule can lose points
+            int ixFirst, ixLast, iyFirst, iyLast;
+            if(!GetColumnRange(capsules, i, ixFirst, ixLast, iyFirst, iyLast))
+            {
+                continue;
+            }
+            
+            const Capsule capsule = capsules.Get(i);
             
             // Gather points to delete on travel path between start and end time
-            for (int ix = 0; ix < m_nx; ix++)
+            for (int ix = ixFirst; ix <= ixLast; ix++)
             {
-                for (int iy = 0; iy < m_ny; iy++)
+                for (int iy = iyFirst; iy <= iyLast; iy++)
                 {
-                    // Iterate zVector backwards so array size can change while deleting
-                    std::vector<Point3<double>>& zVector = m_pointCloud[ix][iy];
-                    for (int iz = static_cast<int>(zVector.size()) - 1; iz >= 0 ; iz--)
+                    // Iterate column backwards so its size can change while deleting
+                    const size_t columnIndex = GetColumnIndex(ix, iy);
+                    Point3D* column = GetColumn(columnIndex);
+                    int& columnSize = m_columnSizes[columnIndex];
+                    for (int iz = columnSize - 1; iz >= 0 ; iz--)
                     {
-                        const Point3D& curPoint = zVector[iz];
-                        
-                        // Delete points around sphere start point, end point and on travel path (cylinder)
-                        if(startTime <= 0 && IsPointInSphere(curPoint, sphereStartPoint, sphereRadiusSquared)
-                            || IsPointInSphere(curPoint, sphereEndPoint, sphereRadiusSquared)
-                            || IsPointInCylinder(curPoint, sphereStartPoint, cylinderAxis, sphereRadiusSquared))
+                        if(IsPointInCapsule(column[iz], capsule))
                         {
-                            zVector.erase(zVector.begin() + iz);
+                            std::copy(column + iz + 1, column + columnSize, column + iz);
+                            columnSize--;
                         }                       
                     }
                 }
             }
+        }
+    }
 
-            // Go to next point
-            startTime = endTime;
-            sphereStartPoint = sphereEndPoint;
-            
-            // Increase and correct next step in case it overshoots
-            endTime += deltaT;
-            if(startTime < 1.0 && endTime > 1.0)
+    /// Removes all points inside the capsules of a compiled sphere path by distributing the capsules across threads
+    /// @note Removal is a set union, so the result is the same as of RemovePointsInCapsules.
+    /// Threads mark removed points in a shared per-column bit mask with atomic or-updates and
+    /// the columns are compacted once all capsules are done.
+    /// 
+    ///	@param capsules compiled sphere path
+    ///	@param threadCount number of threads, 0 uses the number of hardware threads
+    void PointCloud::RemovePointsInCapsulesParallel(const CapsuleList& capsules, unsigned int threadCount)
+    {
+        threadCount = GetThreadCount(threadCount);
+
+        // Bit iz of a column mask is set, if point iz of the column has to be removed.
+        // The mask of a slab is placed on the node of the slab, like the columns themselves
+        const size_t wordsPerColumn = (static_cast<size_t>(m_nz) + 63) / 64;
+        const mem::CloudBuffer removalMaskBuffer(m_columnSizes.size() * wordsPerColumn * sizeof(std::atomic<std::uint64_t>), m_allocationPolicy);
+        std::atomic<std::uint64_t>* removalMask = static_cast<std::atomic<std::uint64_t>*>(removalMaskBuffer.Data());
+        m_isPinned &= RunOnColumnSlabs(m_nx, m_layout, m_threadCount, [&](const int ixBegin, const int ixEnd)
+        {
+            for (int ix = ixBegin; ix < ixEnd; ix++)
             {
-                endTime = 1.0;
+                for (int iy = 0; iy < m_ny; iy++)
+                {
+                    std::atomic<std::uint64_t>* columnMask = &removalMask[GetColumnIndex(ix, iy) * wordsPerColumn];
+                    for (size_t i = 0; i < wordsPerColumn; i++)
+                    {
+                        new (&columnMask[i]) std::atomic<std::uint64_t>(0);
+                    }
+                }
             }
+        });
+
+        // Threads pull capsules one by one, so concentrated and spread out paths are balanced equally.
+        // A capsule can be anywhere in the cloud, so marking is not local to a NUMA node,
+        // only initialization and compaction are
+        std::atomic<size_t> nextCapsule(0);
+        const auto markCapsules = [&]()
+        {
+            for (size_t i = nextCapsule++; i < capsules.Size(); i = nextCapsule++)
+            {
+                int ixFirst, ixLast, iyFirst, iyLast;
+                if(!GetColumnRange(capsules, i, ixFirst, ixLast, iyFirst, iyLast))
+                {
+                    continue;
+                }
+
+                const Capsule capsule = capsules.Get(i);
+                for (int ix = ixFirst; ix <= ixLast; ix++)
+                {
+                    for (int iy = iyFirst; iy <= iyLast; iy++)
+                    {
+                        const size_t columnIndex = GetColumnIndex(ix, iy);
+                        const Point3D* column = GetColumn(columnIndex);
+                        const int columnSize = m_columnSizes[columnIndex];
+                        std::atomic<std::uint64_t>* columnMask = &removalMask[columnIndex * wordsPerColumn];
+                        for (int iz = 0; iz < columnSize; iz++)
+                        {
+                            const std::uint64_t bit = std::uint64_t(1) << (iz % 64);
+                            std::atomic<std::uint64_t>& word = columnMask[iz / 64];
+                            if(!(word.load(std::memory_order_relaxed) & bit) && IsPointInCapsule(column[iz], capsule))
+                            {
+                                word.fetch_or(bit, std::memory_order_relaxed);
+                            }
+                        }
+                    }
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (unsigned int i = 1; i < threadCount; i++)
+        {
+            threads.emplace_back(markCapsules);
         }
-    };
+        markCapsules();
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        // Remove all marked points, every slab is compacted by the thread that touched it first
+        m_isPinned &= RunOnColumnSlabs(m_nx, m_layout, m_threadCount, [&](const int ixBegin, const int ixEnd)
+        {
+            for (int ix = ixBegin; ix < ixEnd; ix++)
+            {
+                for (int iy = 0; iy < m_ny; iy++)
+                {
+                    const size_t columnIndex = GetColumnIndex(ix, iy);
+                    Point3D* column = GetColumn(columnIndex);
+                    int& columnSize = m_columnSizes[columnIndex];
+                    const std::atomic<std::uint64_t>* columnMask = &removalMask[columnIndex * wordsPerColumn];
+                    int keptCount = 0;
+                    for (int iz = 0; iz < columnSize; iz++)
+                    {
+                        if(!(columnMask[iz / 64].load(std::memory_order_relaxed) & (std::uint64_t(1) << (iz % 64))))
+                        {
+                            column[keptCount++] = column[iz];
+                        }
+                    }
 
+                    columnSize = keptCount;
+                }
+            }
+        });
+    }
+
+    /// Get the current top point of the column nearest to the given position
+    ///
+    /// @param x x coordinate of the position
+    /// @param y y coordinate of the position
+    /// @param topPoint uppermost remaining point of the column
+    /// @return false, if the position is outside of the cloud or all points of the column are removed
+    bool PointCloud::GetTopPoint(const double x, const double y, Point3D& topPoint) const
+    {
+        const double ix = std::round((x - m_refPoint.x()) / m_deltaS);
+        const double iy = std::round((y - m_refPoint.y()) / m_deltaS);
+        if(ix < 0 || ix > m_nx - 1 || iy < 0 || iy > m_ny - 1)
+        {
+            return false;
+        }
+
+        const size_t columnIndex = GetColumnIndex(static_cast<int>(ix), static_cast<int>(iy));
+        const int columnSize = m_columnSizes[columnIndex];
+        if(columnSize == 0)
+        {
+            return false;
+        }
+
+        topPoint = GetColumn(columnIndex)[columnSize - 1];
+        return true;
+    }
+
+    /// Call the function for the top point of every column in output order, x major then y
+    /// @note the linear layout is already stored in output order. The tiled layout is gathered one row of tiles
+    /// at a time in memory order, so only the top points of tileSize * ny columns are buffered
+    ///
+    /// @param function called with ix, iy and the top point of the column, or nullptr if the column has no points
+    template <class Function>
+    void PointCloud::ForEachTopPoint(Function function) const
+    {
+        if(m_layout == ColumnLayout::Linear)
+        {
+            for (int ix = 0; ix < m_nx; ix++)
+            {
+                for (int iy = 0; iy < m_ny; iy++)
+                {
+                    const size_t columnIndex = GetColumnIndex(ix, iy);
+                    const int columnSize = m_columnSizes[columnIndex];
+                    function(ix, iy, columnSize == 0 ? nullptr : &GetColumn(columnIndex)[columnSize - 1]);
+                }
+            }
+            return;
+        }
+
+        std::vector<const Point3D*> topPoints(static_cast<size_t>(tileSize) * m_ny);
+        for (int ixTile = 0; ixTile < m_nx; ixTile += tileSize)
+        {
+            const int ixEnd = std::min(ixTile + tileSize, m_nx);
+            for (int iyTile = 0; iyTile < m_ny; iyTile += tileSize)
+            {
+                const int iyEnd = std::min(iyTile + tileSize, m_ny);
+                for (int ix = ixTile; ix < ixEnd; ix++)
+                {
+                    for (int iy = iyTile; iy < iyEnd; iy++)
+                    {
+                        const size_t columnIndex = GetColumnIndex(ix, iy);
+                        const int columnSize = m_columnSizes[columnIndex];
+                        topPoints[static_cast<size_t>(ix - ixTile) * m_ny + iy] =
+                            columnSize == 0 ? nullptr : &GetColumn(columnIndex)[columnSize - 1];
+                    }
+                }
+            }
+
+            for (int ix = ixTile; ix < ixEnd; ix++)
+            {
+                for (int iy = 0; iy < m_ny; iy++)
+                {
+                    function(ix, iy, topPoints[static_cast<size_t>(ix - ixTile) * m_ny + iy]);
+                }
+            }
+        }
+    }
 
     /// Calculate all points visible from above and saves them to the given file path
     ///
@@ -127,18 +492,103 @@ namespace geo
         const io::TestOutput to(outputFileName);
 
         // Write uppermost points to file
-        for (auto& xyMatrix : m_pointCloud)
+        ForEachTopPoint([&](const int, const int, const Point3D* topPoint)
         {
-            for (auto& zVector : xyMatrix)
+            if(topPoint)
             {
-                if(zVector.empty())
-                {
-                    continue;
-                }
-                
-                to.Write(zVector.back());
+                to.Write(*topPoint);
             }
+        });
+    }
+
+    /// Calculate all columns whose top point was changed by the cut and saves them to the given file path
+    /// @note untouched columns keep the original stock top, see io::ExpandDeltaOutput to rebuild the full result
+    ///
+    /// @param outputFileName name of the output file with result
+    void PointCloud::CalculateChangedColumnsAndSaveToFile (
+            const std::filesystem::path& outputFileName) const
+    {
+        const io::DeltaOutput to(outputFileName, m_refPoint, m_nx, m_ny, m_nz, m_deltaS);
+
+        // Original top is accumulated like in the constructor, so it compares exactly
+        double topZ = m_refPoint.z();
+        for (int iz = 1; iz < m_nz; iz++)
+        {
+            topZ += m_deltaS;
+        }
+
+        ForEachTopPoint([&](const int ix, const int iy, const Point3D* topPoint)
+        {
+            if(!topPoint)
+            {
+                to.WriteColumn(ix, iy, -1);
+            }
+            else if(topPoint->z() != topZ)
+            {
+                to.WriteColumn(ix, iy, static_cast<int>(std::lround((topPoint->z() - m_refPoint.z()) / m_deltaS)));
+            }
+        });
+    }
+
+    /// Map a column to its position in the storage. In the tiled layout the columns are grouped in tiles of
+    /// tileSize * tileSize columns, which are stored one after another, x major then y, and so are the columns inside a tile.
+    ///
+    /// @return index of the column in the storage
+    size_t PointCloud::GetColumnIndex(const int ix, const int iy) const
+    {
+        if(m_layout == ColumnLayout::Linear)
+        {
+            return static_cast<size_t>(ix) * m_ny + iy;
         }
+
+        const size_t tileIndex = static_cast<size_t>(ix / tileSize) * m_tileCountY + iy / tileSize;
+        return tileIndex * tileSize * tileSize + (ix % tileSize) * tileSize + iy % tileSize;
+    }
+
+    /// @param columnIndex index of the column in the storage, see GetColumnIndex
+    /// @return first point of the column, the remaining points of the column are stored consecutively in ascending z order
+    Point3D* PointCloud::GetColumn(const size_t columnIndex) const
+    {
+        return m_points + columnIndex * m_nz;
+    }
+
+    /// Calculate the columns inside the bounding box of a capsule
+    ///
+    /// @param capsules compiled sphere path
+    /// @param i index of the capsule
+    /// @param ixFirst first column along x axis
+    /// @param ixLast last column along x axis
+    /// @param iyFirst first column along y axis
+    /// @param iyLast last column along y axis
+    /// @return true, if the bounding box overlaps the cloud
+    bool PointCloud::GetColumnRange(const CapsuleList& capsules, const size_t i, int& ixFirst, int& ixLast, int& iyFirst, int& iyLast) const
+    {
+        return GetIndexRange(capsules.minX[i], capsules.maxX[i], m_refPoint.x(), m_nx, ixFirst, ixLast)
+            && GetIndexRange(capsules.minY[i], capsules.maxY[i], m_refPoint.y(), m_ny, iyFirst, iyLast);
+    }
+
+    /// Calculate the range of grid indices along one axis that lie within an interval
+    ///
+    /// @param minValue lower bound of the interval
+    /// @param maxValue upper bound of the interval
+    /// @param refValue coordinate of the grid index 0 along this axis
+    /// @param count number of grid points along this axis
+    /// @param first first index of the range
+    /// @param last last index of the range
+    /// @note the range is widened by one index on each side to be robust against rounding
+    /// @return true, if the range is not empty
+    bool PointCloud::GetIndexRange(const double minValue, const double maxValue, const double refValue, const int count, int& first, int& last) const
+    {
+        const double firstIndex = std::floor((minValue - refValue) / m_deltaS) - 1;
+        const double lastIndex = std::ceil((maxValue - refValue) / m_deltaS) + 1;
+        if(lastIndex < 0 || firstIndex > count - 1)
+        {
+            return false;
+        }
+
+        first = firstIndex < 0 ? 0 : static_cast<int>(firstIndex);
+        last = lastIndex > count - 1 ? count - 1 : static_cast<int>(lastIndex);
+        return true;
     }
 
     /// Calculate if point lies in sphere
@@ -153,22 +603,39 @@ namespace geo
         return (point - sphereCenter).Length2() <= sphereRadiusSquared;
     }
 
+    /// Calculate if point lies in capsule, which is swept by the sphere from start to end point
+    ///
+    /// @param point point to check if in capsule
+    /// @param capsule invariants of the capsule
+    /// @return true, if point lies in capsule
+    bool PointCloud::IsPointInCapsule(const Point3D point, const Capsule& capsule)
+    {
+        const double sphereRadiusSquared = capsule.sphereRadiusSquared;
+
+        // Delete points around sphere start point, end point and on travel path (cylinder)
+        return (capsule.hasStartSphere && IsPointInSphere(point, capsule.startPoint, sphereRadiusSquared))
+            || IsPointInSphere(point, capsule.endPoint, sphereRadiusSquared)
+            || IsPointInCylinder(point, capsule.startPoint, capsule.axis, capsule.startDotAxis, capsule.inverseAxisLength2, sphereRadiusSquared);
+    }
+
     /// Calculate if point lies in cylinder
     ///
     /// @param point point to check if in cylinder
     /// @param bottomPoint bottom point of the cylinder
     /// @param axis axis of the cylinder, has to contain full height of cylinder and must not be normed!
+    /// @param bottomDotAxis precomputed bottomPoint * axis
+    /// @param inverseAxisLength2 precomputed 1 / (axis * axis)
     /// @param sphereRadiusSquared the radius of the sphere squared
     /// @note squared radius is used to avoid use of expensive square root
     /// @return true, if point lies in cylinder
-    bool PointCloud::IsPointInCylinder(const Point3D point, const Point3D bottomPoint, const Point3D axis, const double sphereRadiusSquared)
+    bool PointCloud::IsPointInCylinder(const Point3D point, const Point3D bottomPoint, const Point3D axis, const double bottomDotAxis, const double inverseAxisLength2, const double sphereRadiusSquared)
     {
         // Calculate perpendicular distance of point to axis
         // If lineSegment lies not on the axis, disregard it
         // Algorithm Basics:
         // (1) (curPoint - orthoIntersectionPoint) * axis = 0
         // (2) orthoIntersectPoint = bottomPoint + axis * lineSegment
-        const double lineSegment = (point * axis - bottomPoint * axis) / (axis * axis);
+        const double lineSegment = (point * axis - bottomDotAxis) * inverseAxisLength2;
         
         if(lineSegment < 0 || lineSegment > 1)
         {
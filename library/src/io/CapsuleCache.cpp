@@ -0,0 +1,219 @@
+#include "io/CapsuleCache.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <system_error>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace io
+{
+namespace
+{
+constexpr char cacheMagic[4] = {'C', 'A', 'P', 'S'};
+constexpr std::uint32_t cacheVersion = 4;
+
+/// FNV-1a hash, stable across runs and platforms
+std::uint64_t Hash(std::uint64_t hash, const void* data, const size_t size)
+{
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+/// All arrays of the capsule list in the order they are stored in the cache file
+template <class CapsuleListType, class Function>
+void ForEachArray(CapsuleListType& capsules, Function function)
+{
+	function(capsules.startX);
+	function(capsules.startY);
+	function(capsules.startZ);
+	function(capsules.endX);
+	function(capsules.endY);
+	function(capsules.endZ);
+	function(capsules.axisX);
+	function(capsules.axisY);
+	function(capsules.axisZ);
+	function(capsules.inverseAxisLength2);
+	function(capsules.startDotAxis);
+	function(capsules.minX);
+	function(capsules.maxX);
+	function(capsules.minY);
+	function(capsules.maxY);
+	function(capsules.minZ);
+	function(capsules.maxZ);
+	function(capsules.hasStartSphere);
+	function(capsules.tool);
+}
+}  // namespace
+
+/// Create cache entry for a test file
+///
+/// @param cacheDirectory directory of the cache files, created on the first save
+/// @param testFile test file, whose program is compiled
+/// @param isMergingCollinear true, if collinear capsules are merged, see geo::CapsuleList::Simplify
+/// @note "cloud" lines are not part of the key, so runs against different stocks share the entry.
+/// The "cloud" and "delta" lines are kept, so a cache hit does not have to parse the file again
+CapsuleCache::CapsuleCache(
+	const std::filesystem::path& cacheDirectory,
+	const std::filesystem::path& testFile,
+	const bool isMergingCollinear)
+{
+	std::ifstream f(testFile);
+	if (!f)
+		throw std::runtime_error("failed to open test file!");
+
+	m_key = 14695981039346656037ull;
+	std::string line;
+	while (std::getline(f, line))
+	{
+		std::istringstream iss(line);
+		std::string cmd;
+		if (iss >> cmd && (cmd == "cloud" || cmd == "delta"))
+			m_settingLines.push_back(line);
+		if (cmd == "cloud")
+			continue;
+
+		m_key = Hash(m_key, line.data(), line.size());
+		m_key = Hash(m_key, "\n", 1);
+	}
+	m_key = Hash(m_key, &isMergingCollinear, sizeof(isMergingCollinear));
+
+	char fileName[32];
+	std::snprintf(fileName, sizeof(fileName), "%016llx.caps", static_cast<unsigned long long>(m_key));
+	m_cacheDirectory = cacheDirectory;
+	m_cacheFile = cacheDirectory / fileName;
+}
+
+/// @return "cloud" and "delta" lines of the test file in file order
+const std::vector<std::string>& CapsuleCache::GetSettingLines() const
+{
+	return m_settingLines;
+}
+
+/// Load the compiled sphere path from the cache
+///
+/// @param capsules capsule list to fill, only changed on success
+/// @param statistics statistics of geo::CapsuleList::Simplify at the time the entry was saved, only changed on success
+/// @return true, if a valid cache entry was found
+/// @note the counts in the header are checked against the file size, so a corrupted entry is just a miss
+bool CapsuleCache::Load(geo::CapsuleList& capsules, geo::SimplifyStatistics& statistics) const
+{
+	std::error_code error;
+	const std::uintmax_t fileSize = std::filesystem::file_size(m_cacheFile, error);
+	if (error)
+		return false;
+
+	std::ifstream f(m_cacheFile, std::ios::binary);
+	if (!f)
+		return false;
+
+	char magic[4];
+	std::uint32_t version;
+	std::uint64_t key, toolCount, size;
+	std::uint64_t counts[3];
+	if (!f.read(magic, sizeof(magic)) || !f.read(reinterpret_cast<char*>(&version), sizeof(version))
+		|| !f.read(reinterpret_cast<char*>(&key), sizeof(key))
+		|| !f.read(reinterpret_cast<char*>(&toolCount), sizeof(toolCount))
+		|| !f.read(reinterpret_cast<char*>(&size), sizeof(size))
+		|| !f.read(reinterpret_cast<char*>(counts), sizeof(counts)))
+		return false;
+
+	if (!std::equal(magic, magic + sizeof(magic), cacheMagic) || version != cacheVersion || key != m_key)
+		return false;
+
+	geo::CapsuleList loaded;
+	std::uint64_t capsuleBytes = 0;
+	ForEachArray(loaded, [&](const auto& array) { capsuleBytes += sizeof(array[0]); });
+	const std::uint64_t headerBytes =
+		sizeof(magic) + sizeof(version) + sizeof(key) + sizeof(toolCount) + sizeof(size) + sizeof(counts);
+	const std::uint64_t toolBytes = 2 * sizeof(double);
+	if (fileSize < headerBytes || toolCount > (fileSize - headerBytes) / toolBytes
+		|| size > (fileSize - headerBytes - toolCount * toolBytes) / capsuleBytes
+		|| headerBytes + toolCount * toolBytes + size * capsuleBytes != fileSize)
+		return false;
+
+	loaded.toolRadius.resize(toolCount);
+	loaded.toolRadiusSquared.resize(toolCount);
+	bool isValid =
+		f.read(reinterpret_cast<char*>(loaded.toolRadius.data()), toolCount * sizeof(double))
+		&& f.read(reinterpret_cast<char*>(loaded.toolRadiusSquared.data()), toolCount * sizeof(double));
+	ForEachArray(loaded, [&](auto& array) {
+		array.resize(size);
+		isValid = isValid
+			&& f.read(reinterpret_cast<char*>(array.data()), size * sizeof(array[0]));
+	});
+	if (!isValid
+		|| std::any_of(loaded.tool.begin(), loaded.tool.end(), [&](std::uint32_t tool) { return tool >= toolCount; }))
+		return false;
+
+	capsules = std::move(loaded);
+	statistics = geo::SimplifyStatistics();
+	statistics.inputCount = counts[0];
+	statistics.mergedCount = counts[1];
+	statistics.zeroLengthCount = counts[2];
+	statistics.outputCount = size;
+	return true;
+}
+
+/// Save the compiled sphere path to the cache
+///
+/// @param capsules compiled sphere path
+/// @param statistics statistics of geo::CapsuleList::Simplify, that produced the capsules
+/// @return true, if the entry was written
+/// @note written to a unique temporary file first, so concurrent runs never read a partial entry.
+/// A failure is not fatal, the next run just compiles the program again
+bool CapsuleCache::Save(const geo::CapsuleList& capsules, const geo::SimplifyStatistics& statistics) const
+{
+	std::error_code error;
+	std::filesystem::create_directories(m_cacheDirectory, error);
+	if (error)
+		return false;
+
+	std::filesystem::path tempFile = m_cacheFile;
+	tempFile += "." + std::to_string(std::random_device()()) + ".tmp";
+	{
+		std::ofstream f(tempFile, std::ios::binary);
+		if (!f)
+			return false;
+
+		const std::uint64_t toolCount = capsules.toolRadius.size();
+		const std::uint64_t size = capsules.Size();
+		const std::uint64_t counts[3] = {statistics.inputCount, statistics.mergedCount, statistics.zeroLengthCount};
+		f.write(cacheMagic, sizeof(cacheMagic));
+		f.write(reinterpret_cast<const char*>(&cacheVersion), sizeof(cacheVersion));
+		f.write(reinterpret_cast<const char*>(&m_key), sizeof(m_key));
+		f.write(reinterpret_cast<const char*>(&toolCount), sizeof(toolCount));
+		f.write(reinterpret_cast<const char*>(&size), sizeof(size));
+		f.write(reinterpret_cast<const char*>(counts), sizeof(counts));
+		f.write(reinterpret_cast<const char*>(capsules.toolRadius.data()), toolCount * sizeof(double));
+		f.write(reinterpret_cast<const char*>(capsules.toolRadiusSquared.data()), toolCount * sizeof(double));
+		ForEachArray(capsules, [&](const auto& array) {
+			f.write(reinterpret_cast<const char*>(array.data()), size * sizeof(array[0]));
+		});
+
+		if (!f)
+		{
+			f.close();
+			std::filesystem::remove(tempFile, error);
+			return false;
+		}
+	}
+	std::filesystem::rename(tempFile, m_cacheFile, error);
+	if (error)
+	{
+		std::filesystem::remove(tempFile, error);
+		return false;
+	}
+	return true;
+}
+}  // namespace io
@@ -0,0 +1,150 @@
+#include "io/DeltaOutput.hpp"
+
+#include "io/TestOutput.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace io
+{
+/// Create delta result file and write the header describing the original stock block
+///
+/// @param outputFile name of the output file
+/// @param refPoint reference point of the cloud
+/// @param nx number of points in cloud along x axis
+/// @param ny number of points in cloud along y axis
+/// @param nz number of points in cloud along z axis
+/// @param deltaS distance between neighboring cloud points
+DeltaOutput::DeltaOutput(
+	const std::filesystem::path& outputFile,
+	const geo::Point3D& refPoint,
+	const int nx,
+	const int ny,
+	const int nz,
+	const double deltaS)
+{
+	m_fd = NULL;
+#ifdef _WIN32
+	_wfopen_s(&m_fd, outputFile.c_str(), L"wt");
+#else
+	m_fd = fopen(outputFile.c_str(), "wt");
+#endif
+	if (m_fd == NULL)
+	{
+		throw std::runtime_error("Cannot open output file");
+	}
+
+	// Full precision, so the expanded result has exactly the same coordinates
+	fprintf(
+		m_fd,
+		"stock %.17g %.17g %.17g %d %d %d %.17g\n",
+		refPoint.x(),
+		refPoint.y(),
+		refPoint.z(),
+		nx,
+		ny,
+		nz,
+		deltaS);
+}
+DeltaOutput::~DeltaOutput()
+{
+	if (m_fd)
+	{
+		fclose(m_fd);
+	}
+}
+void DeltaOutput::WriteColumn(const int ix, const int iy, const int iz) const
+{
+	fprintf(m_fd, "%d %d %d\n", ix, iy, iz);
+}
+
+/// Rebuild the full result file from a delta result file
+///
+/// @param deltaFile delta result file
+/// @param outputFile name of the full result file, same as written by PointCloud::CalculatePointsOnTopAndSaveToFile
+/// @throws std::runtime_error if the header or a column is invalid, out of range or out of order
+void ExpandDeltaOutput(const std::filesystem::path& deltaFile, const std::filesystem::path& outputFile)
+{
+	std::ifstream f(deltaFile);
+	if (!f)
+		throw std::runtime_error("failed to open delta file!");
+
+	std::string line;
+	std::string cmd;
+	double refX, refY, refZ, deltaS;
+	int nx, ny, nz;
+	if (!std::getline(f, line)
+		|| !(std::istringstream(line) >> cmd >> refX >> refY >> refZ >> nx >> ny >> nz >> deltaS)
+		|| cmd != "stock" || nx <= 0 || ny <= 0 || nz <= 0 || deltaS <= 0)
+		throw std::runtime_error(
+			"invalid \"stock\" format! must be: \"stock refPoint nx ny nz delta\".");
+
+	// Coordinates are accumulated like in the PointCloud constructor
+	std::vector<double> zValues(nz);
+	double z = refZ;
+	for (int iz = 0; iz < nz; iz++)
+	{
+		zValues[iz] = z;
+		z += deltaS;
+	}
+
+	// Changed columns have to be inside the stock and in the order they are written, x major then y
+	int previousX = -1, previousY = ny - 1;
+	const auto readColumn = [&](int& ix, int& iy, int& iz) {
+		while (std::getline(f, line))
+		{
+			std::istringstream iss(line);
+			std::string rest;
+			if (!(iss >> ix >> iy >> iz))
+			{
+				if (line.find_first_not_of(" \t\r") == std::string::npos)
+					continue;
+				throw std::runtime_error("invalid column format in delta file! must be: \"ix iy iz\".");
+			}
+			if (iss >> rest)
+				throw std::runtime_error("invalid column format in delta file! must be: \"ix iy iz\".");
+			if (ix < 0 || ix >= nx || iy < 0 || iy >= ny || iz < -1 || iz >= nz)
+				throw std::runtime_error("column out of range in delta file!");
+			if (ix < previousX || (ix == previousX && iy <= previousY))
+				throw std::runtime_error("columns out of order in delta file!");
+
+			previousX = ix;
+			previousY = iy;
+			return;
+		}
+		ix = nx;
+		iy = ny;
+		iz = -1;
+	};
+
+	const TestOutput to(outputFile);
+	int changedX, changedY, changedZ;
+	readColumn(changedX, changedY, changedZ);
+	double x = refX;
+	for (int ix = 0; ix < nx; ix++)
+	{
+		double y = refY;
+		for (int iy = 0; iy < ny; iy++)
+		{
+			if (ix == changedX && iy == changedY)
+			{
+				if (changedZ >= 0)
+					to.Write(geo::Point3D(x, y, zValues[changedZ]));
+
+				readColumn(changedX, changedY, changedZ);
+			}
+			else
+			{
+				to.Write(geo::Point3D(x, y, zValues[nz - 1]));
+			}
+
+			y += deltaS;
+		}
+
+		x += deltaS;
+	}
+}
+}  // namespace io
@@ -0,0 +1,34 @@
+#include "io/OutputMerge.hpp"
+
+#include <fstream>
+#include <stdexcept>
+
+namespace io
+{
+/// Concatenate the results of all partitions in the given order into one result file
+///
+/// @param partialOutputs result files of the partitions, ordered by partition index
+/// @param outputFile name of the merged result file
+void MergeOutputs(
+	const std::vector<std::filesystem::path>& partialOutputs,
+	const std::filesystem::path& outputFile)
+{
+	std::ofstream out(outputFile, std::ios::binary);
+	if (!out)
+		throw std::runtime_error("Cannot open output file");
+
+	for (const std::filesystem::path& partialOutput : partialOutputs)
+	{
+		std::ifstream in(partialOutput, std::ios::binary);
+		if (!in)
+			throw std::runtime_error("Cannot open partial output file");
+
+		// An empty partition yields an empty file, which would set failbit on the copy
+		if (in.peek() != std::ifstream::traits_type::eof())
+			out << in.rdbuf();
+	}
+
+	if (!out)
+		throw std::runtime_error("Cannot write output file");
+}
+}  // namespace io
@@ -7,6 +7,8 @@
 
 namespace io
 {
+TestInput::TestInput() {}
+
 TestInput::TestInput(const std::filesystem::path& testFile)
 {
 	std::ifstream f(testFile);
@@ -14,85 +16,100 @@ TestInput::TestInput(const std::filesystem::path& testFile)
 	if (!f)
 		throw std::runtime_error("failed to open test file!");
 
-	geo::Point3D prevPoint(0, 0, 0);
-
 	std::string line;
 	while (std::getline(f, line))
 	{
-		size_t i = line.find('#');
-		if (i != std::string::npos)
-			line.erase(i);
-
-		std::istringstream iss(line);
-
-		std::string cmd;
-		if (!(iss >> cmd) || cmd.empty())
-			continue;
-
-		if (cmd == "cloud")
-		{
-			double posX, posY, posZ;
-			if (!(iss >> posX >> posY >> posZ >> cloudNX >> cloudNY >> cloudNZ >> cloudDeltaS))
-				throw std::runtime_error(
-					"invalid \"cloud\" format! \"cloud refPoint nx ny nz delta\".");
-
-			cloudReferencePoint.x(posX);
-			cloudReferencePoint.y(posY);
-			cloudReferencePoint.z(posZ);
-		}
-		else if (cmd == "delta")
-		{
-			if (!(iss >> curveDeltaT))
-				throw std::runtime_error("invalid \"delta\" format! must be: \"delta deltaT\".");
-		}
-		else if (cmd == "sphere")
-		{
-			if (!(iss >> sphereRadius))
-				throw std::runtime_error(
-					"invalid \"sphere\" format! must be: \"sphere sphereRadius\".");
-		}
-		else if (cmd == "start")
-		{
-			double posX, posY, posZ;
-			if (!(iss >> posX >> posY >> posZ))
-				throw std::runtime_error("invalid \"start\" format! must be: \"start startPos\".");
-
-			prevPoint = geo::Point3D(posX, posY, posZ);
-		}
-		else if (cmd == "line")
-		{
-			double posX, posY, posZ;
-			if (!(iss >> posX >> posY >> posZ))
-				throw std::runtime_error("invalid \"line\" format! must be: \"line nextPos\".");
-
-			geo::Point3D nextPoint(posX, posY, posZ);
-
-			curve.reset(new geo::Line(prevPoint, nextPoint));
-
-			prevPoint = nextPoint;
-		}
-		else if (cmd == "arc")
-		{
-			double pos2_x, pos2_y, pos2_z;
-			double pos3_x, pos3_y, pos3_z;
-			bool isCounterClockwise;
-			if (!(iss >> pos2_x >> pos2_y >> pos2_z >> pos3_x >> pos3_y >> pos3_z
-				  >> isCounterClockwise))
-				throw std::runtime_error(
-					"invalid \"arc\" format! must be: \"arc nextPos arcCenter "
-					"isCounterClockwise\"");
-
-			geo::Point3D nextPoint(pos2_x, pos2_y, pos2_z);
-			geo::Point3D arc_center(pos3_x, pos3_y, pos3_z);
-
-			curve.reset(new geo::Arc(prevPoint, nextPoint, arc_center, isCounterClockwise));
-
-			prevPoint = nextPoint;
-		}
-		else
-		{
-			throw std::runtime_error("unknown command!");
-		}
+		ParseLine(line);
+	}
+}
+
+/// Parse one line of the input format and apply it
+///
+/// @param line line of the input file, may contain a comment
+/// @return command of the line, Command::Empty for empty and comment lines
+TestInput::Command TestInput::ParseLine(std::string line)
+{
+	size_t i = line.find('#');
+	if (i != std::string::npos)
+		line.erase(i);
+
+	std::istringstream iss(line);
+
+	std::string cmd;
+	if (!(iss >> cmd) || cmd.empty())
+		return Command::Empty;
+
+	if (cmd == "cloud")
+	{
+		double posX, posY, posZ;
+		if (!(iss >> posX >> posY >> posZ >> cloudNX >> cloudNY >> cloudNZ >> cloudDeltaS))
+			throw std::runtime_error(
+				"invalid \"cloud\" format! \"cloud refPoint nx ny nz delta\".");
+
+		cloudReferencePoint.x(posX);
+		cloudReferencePoint.y(posY);
+		cloudReferencePoint.z(posZ);
+		return Command::Cloud;
+	}
+	else if (cmd == "delta")
+	{
+		if (!(iss >> curveDeltaT))
+			throw std::runtime_error("invalid \"delta\" format! must be: \"delta deltaT\".");
+		return Command::Delta;
+	}
+	else if (cmd == "sphere")
+	{
+		if (!(iss >> sphereRadius))
+			throw std::runtime_error(
+				"invalid \"sphere\" format! must be: \"sphere sphereRadius\".");
+		return Command::Sphere;
+	}
+	else if (cmd == "start")
+	{
+		double posX, posY, posZ;
+		if (!(iss >> posX >> posY >> posZ))
+			throw std::runtime_error("invalid \"start\" format! must be: \"start startPos\".");
+
+		currentPoint = geo::Point3D(posX, posY, posZ);
+		return Command::Start;
+	}
+	else if (cmd == "line")
+	{
+		double posX, posY, posZ;
+		if (!(iss >> posX >> posY >> posZ))
+			throw std::runtime_error("invalid \"line\" format! must be: \"line nextPos\".");
+
+		geo::Point3D nextPoint(posX, posY, posZ);
+
+		moves.push_back({std::make_unique<geo::Line>(currentPoint, nextPoint), sphereRadius});
+
+		currentPoint = nextPoint;
+		return Command::Line;
+	}
+	else if (cmd == "arc")
+	{
+		double pos2_x, pos2_y, pos2_z;
+		double pos3_x, pos3_y, pos3_z;
+		bool isCounterClockwise;
+		if (!(iss >> pos2_x >> pos2_y >> pos2_z >> pos3_x >> pos3_y >> pos3_z
+			  >> isCounterClockwise))
+			throw std::runtime_error(
+				"invalid \"arc\" format! must be: \"arc nextPos arcCenter "
+				"isCounterClockwise\"");
+
+		geo::Point3D nextPoint(pos2_x, pos2_y, pos2_z);
+		geo::Point3D arc_center(pos3_x, pos3_y, pos3_z);
+
+		moves.push_back(
+			{std::make_unique<geo::Arc>(currentPoint, nextPoint, arc_center, isCounterClockwise),
+			 sphereRadius});
+
+		currentPoint = nextPoint;
+		return Command::Arc;
+	}
+	else
+	{
+		throw std::runtime_error("unknown command!");
 	}
 }
 
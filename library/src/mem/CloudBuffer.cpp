@@ -0,0 +1,173 @@
+#include "mem/CloudBuffer.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace mem
+{
+    namespace
+    {
+        constexpr size_t hugePageSize = 2 * 1024 * 1024;
+
+#ifdef __linux__
+        constexpr int mpolInterleave = 3;
+
+        /// @return true, if the kernel backs madvise(MADV_HUGEPAGE) ranges with transparent huge pages
+        bool IsTransparentHugePagesEnabled()
+        {
+            // Selected mode is in brackets, e.g. "always [madvise] never"
+            std::ifstream f("/sys/kernel/mm/transparent_hugepage/enabled");
+            std::string mode;
+            if (!std::getline(f, mode))
+            {
+                return false;
+            }
+
+            return mode.find("[always]") != std::string::npos || mode.find("[madvise]") != std::string::npos;
+        }
+
+        /// Interleave the pages of the given range across all online NUMA nodes
+        /// @note uses the raw system call, so there is no dependency on libnuma
+        /// @return true, if the interleave policy was applied
+        bool Interleave(void* data, const size_t size)
+        {
+            std::ifstream f("/sys/devices/system/node/online");
+            std::string nodes;
+            if (!(f >> nodes))
+            {
+                return false;
+            }
+
+            // Node list has the format "0-1,3"
+            unsigned long nodeMask = 0;
+            std::istringstream iss(nodes);
+            std::string range;
+            while (std::getline(iss, range, ','))
+            {
+                const size_t dash = range.find('-');
+                const int first = std::stoi(range.substr(0, dash));
+                const int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+                for (int node = first; node <= last && node < 64; node++)
+                {
+                    nodeMask |= 1ul << node;
+                }
+            }
+
+            if (nodeMask == 0)
+            {
+                return false;
+            }
+
+            return syscall(SYS_mbind, data, size, mpolInterleave, &nodeMask, 64ul, 0u) == 0;
+        }
+#endif
+    }
+
+    /// Parse the name of a huge page backing
+    ///
+    ///	@param name "none", "transparent" or "explicit"
+    ///	@throws std::invalid_argument if the name is unknown
+    HugePages AllocationPolicy::ParseHugePages(const std::string& name)
+    {
+        if(name == "none")
+        {
+            return HugePages::None;
+        }
+        if(name == "transparent")
+        {
+            return HugePages::Transparent;
+        }
+        if(name == "explicit")
+        {
+            return HugePages::Explicit;
+        }
+
+        throw std::invalid_argument("invalid huge pages! must be: \"none\", \"transparent\" or \"explicit\".");
+    }
+
+    /// Allocate uninitialized memory, no page is touched before the caller initializes it
+    /// @note explicit huge pages fall back to transparent huge pages if none are reserved,
+    /// huge pages and interleaving are ignored on other platforms than Linux
+    ///
+    ///	@param size size in bytes
+    ///	@param policy allocation policy
+    ///	@throws std::bad_alloc if the memory cannot be allocated
+    CloudBuffer::CloudBuffer(
+        const size_t size,
+        const AllocationPolicy& policy): m_data(nullptr),
+        m_mappedSize(0),
+        m_hugePages(HugePages::None),
+        m_isInterleaved(false)
+    {
+#ifdef __linux__
+        // Anonymous mappings are only backed when touched, which makes first touch placement work
+        m_mappedSize = (size + hugePageSize - 1) / hugePageSize * hugePageSize;
+        if(policy.hugePages == HugePages::Explicit)
+        {
+            m_data = mmap(nullptr, m_mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            m_hugePages = HugePages::Explicit;
+        }
+        if(m_data == nullptr || m_data == MAP_FAILED)
+        {
+            m_data = mmap(nullptr, m_mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            m_hugePages = HugePages::None;
+            if(m_data == MAP_FAILED)
+            {
+                throw std::bad_alloc();
+            }
+            // madvise also succeeds, if transparent huge pages are disabled
+            if(policy.hugePages != HugePages::None && madvise(m_data, m_mappedSize, MADV_HUGEPAGE) == 0
+                && IsTransparentHugePagesEnabled())
+            {
+                m_hugePages = HugePages::Transparent;
+            }
+        }
+        if(policy.isInterleaved)
+        {
+            m_isInterleaved = Interleave(m_data, m_mappedSize);
+        }
+#else
+        m_data = std::malloc(size);
+        if(m_data == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+#endif
+    }
+
+    CloudBuffer::~CloudBuffer()
+    {
+#ifdef __linux__
+        munmap(m_data, m_mappedSize);
+#else
+        std::free(m_data);
+#endif
+    }
+
+    /// @return start of the memory
+    void* CloudBuffer::Data() const
+    {
+        return m_data;
+    }
+
+    /// @return page backing, that was actually achieved
+    HugePages CloudBuffer::GetHugePages() const
+    {
+        return m_hugePages;
+    }
+
+    /// @return true, if the pages are actually interleaved across the NUMA nodes
+    bool CloudBuffer::IsInterleaved() const
+    {
+        return m_isInterleaved;
+    }
+}
@@ -0,0 +1,75 @@
+#include "mem/PerfCounters.hpp"
+
+#include <cstdint>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace mem
+{
+    /// Start counting
+    /// @note TLB misses need access to hardware counters, see /proc/sys/kernel/perf_event_paranoid
+    PerfCounters::PerfCounters(): m_minorFaults(0),
+        m_majorFaults(0),
+        m_tlbMissesFd(-1)
+    {
+#ifdef __linux__
+        rusage usage {};
+        getrusage(RUSAGE_SELF, &usage);
+        m_minorFaults = usage.ru_minflt;
+        m_majorFaults = usage.ru_majflt;
+
+        // Data TLB load misses of this thread and all threads created later
+        perf_event_attr attr {};
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_DTLB
+            | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+            | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        m_tlbMissesFd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+
+    PerfCounters::~PerfCounters()
+    {
+#ifdef __linux__
+        if(m_tlbMissesFd >= 0)
+        {
+            close(m_tlbMissesFd);
+        }
+#endif
+    }
+
+    /// Print the counters since construction
+    ///
+    ///	@param out stream to print to
+    void PerfCounters::Print(std::ostream& out) const
+    {
+#ifdef __linux__
+        rusage usage {};
+        getrusage(RUSAGE_SELF, &usage);
+        out << "Page faults: " << usage.ru_minflt - m_minorFaults << " minor, "
+            << usage.ru_majflt - m_majorFaults << " major" << std::endl;
+
+        std::uint64_t tlbMisses = 0;
+        if(m_tlbMissesFd >= 0 && read(m_tlbMissesFd, &tlbMisses, sizeof(tlbMisses)) == sizeof(tlbMisses))
+        {
+            out << "dTLB load misses: " << tlbMisses << std::endl;
+        }
+        else
+        {
+            out << "dTLB load misses: not available" << std::endl;
+        }
+#else
+        out << "Page faults and TLB misses: not available" << std::endl;
+#endif
+    }
+}
@@ -1,39 +1,368 @@
 // (C) 2022 by ModuleWorks GmbH
 
+#include "io/CapsuleCache.hpp"
+#include "io/DeltaOutput.hpp"
+#include "io/OutputMerge.hpp"
 #include "io/TestInput.hpp"
+#include "io/TestOutput.hpp"
+#include "geo/CapsuleList.hpp"
+#include "geo/Partition.hpp"
 #include "geo/PointCloud.hpp"
+#include "mem/CloudBuffer.hpp"
+#include "mem/PerfCounters.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <filesystem>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/// Parse the thread count of --segment-threads, 0 uses all hardware threads
+static unsigned int ParseThreadCount(const std::string& value)
+{
+	static constexpr int maxThreadCount = 1024;
+
+	std::istringstream iss(value);
+	int threadCount;
+	if (!(iss >> threadCount) || !iss.eof() || threadCount < 0 || threadCount > maxThreadCount)
+		throw std::invalid_argument(
+			"invalid \"--segment-threads\"! must be a number from 0 to " + std::to_string(maxThreadCount) + ".");
+
+	return static_cast<unsigned int>(threadCount);
+}
+
+/// Print the command line of all modes
+static void PrintUsage()
+{
+	std::cout << "Usage: cutSphereMove <test_in_file> <results_file> [--part i/N] [--segment-threads N] [--cache dir] [--merge-collinear] [--stats] [--delta]" << std::endl;
+	std::cout << "       [--layout linear|tiled] [--huge-pages none|transparent|explicit] [--interleave] [--perf]" << std::endl;
+	std::cout << "       cutSphereMove --merge <results_file> <part_results_file>..." << std::endl;
+	std::cout << "       cutSphereMove --expand <delta_results_file> <results_file>" << std::endl;
+	std::cout << "       cutSphereMove --stream [--merge-collinear] < <commands>" << std::endl;
+}
+
+/// Print percentiles of the latencies of all moves so far
+static void PrintLatencies(std::vector<double> latencies, std::ostream& out)
+{
+	out << "moves " << latencies.size();
+	if (!latencies.empty())
+	{
+		std::sort(latencies.begin(), latencies.end());
+		const auto percentile = [&](const double p) {
+			return latencies[static_cast<size_t>(p * (latencies.size() - 1) + 0.5)];
+		};
+		out << " p50 " << percentile(0.5) << "us p90 " << percentile(0.9) << "us p99 "
+			<< percentile(0.99) << "us max " << latencies.back() << "us";
+	}
+	out << std::endl;
+}
+
+/// Simulate material removal while the machine is running
+///
+/// Reads the input format line by line and applies every move to a persistent cloud as soon as it arrives.
+/// Additional commands: "query x y" prints the current top at (x, y), "stats" prints the move latency percentiles.
+/// Invalid lines are reported and skipped, so a live session is not aborted.
+static void RunStream(std::istream& in, std::ostream& out, const bool isMergingCollinear)
+{
+	io::TestInput test;
+	std::unique_ptr<geo::PointCloud> pointCloud;
+	std::vector<double> latencies;
+
+	std::string line;
+	while (std::getline(in, line))
+	{
+		try
+		{
+			std::istringstream iss(line);
+			std::string cmd;
+			iss >> cmd;
+			if (cmd == "query")
+			{
+				double x, y;
+				if (!(iss >> x >> y))
+					throw std::runtime_error("invalid \"query\" format! must be: \"query x y\".");
+
+				geo::Point3D topPoint;
+				if (pointCloud && pointCloud->GetTopPoint(x, y, topPoint))
+					out << "top " << topPoint.x() << " " << topPoint.y() << " " << topPoint.z() << std::endl;
+				else
+					out << "top " << x << " " << y << " none" << std::endl;
+				continue;
+			}
+			if (cmd == "stats")
+			{
+				PrintLatencies(latencies, out);
+				continue;
+			}
+
+			const io::TestInput::Command command = test.ParseLine(line);
+			if (command == io::TestInput::Command::Cloud)
+			{
+				pointCloud = std::make_unique<geo::PointCloud>(
+					test.cloudReferencePoint,
+					test.cloudNX,
+					test.cloudNY,
+					test.cloudNZ,
+					test.cloudDeltaS);
+			}
+			else if (command == io::TestInput::Command::Line || command == io::TestInput::Command::Arc)
+			{
+				const io::TestInput::Move move = std::move(test.moves.back());
+				test.moves.clear();
+				if (!pointCloud)
+					throw std::runtime_error("\"cloud\" has to be given before the first move!");
+
+				const auto start = std::chrono::steady_clock::now();
+				geo::CapsuleList capsules;
+				capsules.AddCurve(*move.curve, test.curveDeltaT, capsules.AddTool(move.sphereRadius));
+				geo::SimplifyStatistics statistics = capsules.Simplify(isMergingCollinear);
+				capsules.Cull(pointCloud->GetMinPoint(), pointCloud->GetMaxPoint(), statistics);
+				pointCloud->RemovePointsInCapsules(capsules);
+				const auto end = std::chrono::steady_clock::now();
+				latencies.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+			}
+		}
+		catch (std::exception& e)
+		{
+			out << "std::exception: " << e.what() << std::endl;
+		}
+	}
+
+	PrintLatencies(latencies, out);
+}
 
 int main(int argc, char* argv[])
 {
-	if (argc < 3)
+	const std::string mode = argc > 1 ? argv[1] : "";
+	if (mode == "--stream")
 	{
-		std::cout << "Usage: cutSphereMove <test_in_file> <results_file>" << std::endl;
-		return 1;
+		bool isMergingCollinear = false;
+		for (int i = 2; i < argc; i++)
+		{
+			if (std::string(argv[i]) != "--merge-collinear")
+			{
+				std::cout << "unknown stream option: " << argv[i] << std::endl;
+				PrintUsage();
+				return 1;
+			}
+			isMergingCollinear = true;
+		}
+
+		RunStream(std::cin, std::cout, isMergingCollinear);
+		return 0;
 	}
 
-	std::filesystem::path testInput = argv[1];
-	std::filesystem::path testOutput = argv[2];
+	// --merge needs at least one part, --expand exactly one input and one output
+	if (argc < 3 || (mode == "--merge" && argc < 4) || (mode == "--expand" && argc != 4))
+	{
+		PrintUsage();
+		return 1;
+	}
 
 	try
 	{
-		io::TestInput test(testInput);
+		if (mode == "--merge")
+		{
+			std::vector<std::filesystem::path> partialOutputs(argv + 3, argv + argc);
+			io::MergeOutputs(partialOutputs, argv[2]);
+			return 0;
+		}
+		if (mode == "--expand")
+		{
+			io::ExpandDeltaOutput(argv[2], argv[3]);
+			return 0;
+		}
+
+		std::filesystem::path testInput = argv[1];
+		std::filesystem::path testOutput = argv[2];
+
+		geo::Partition partition(0, 1);
+		bool isPartitioned = false;
+		bool isSegmentParallel = false;
+		unsigned int segmentThreadCount = 0;
+		std::optional<std::filesystem::path> cacheDirectory;
+		bool isMergingCollinear = false;
+		bool isPrintingStatistics = false;
+		bool isDeltaOutput = false;
+		geo::ColumnLayout columnLayout = geo::ColumnLayout::Linear;
+		mem::AllocationPolicy allocationPolicy;
+		std::optional<mem::PerfCounters> perfCounters;
+		for (int i = 3; i < argc; i++)
+		{
+			const std::string option = argv[i];
+			if (option == "--part" && i + 1 < argc)
+			{
+				partition = geo::Partition::Parse(argv[++i]);
+				isPartitioned = true;
+			}
+			else if (option == "--segment-threads" && i + 1 < argc)
+			{
+				isSegmentParallel = true;
+				segmentThreadCount = ParseThreadCount(argv[++i]);
+			}
+			else if (option == "--cache" && i + 1 < argc)
+			{
+				cacheDirectory = argv[++i];
+			}
+			else if (option == "--merge-collinear")
+			{
+				isMergingCollinear = true;
+			}
+			else if (option == "--stats")
+			{
+				isPrintingStatistics = true;
+			}
+			else if (option == "--delta")
+			{
+				isDeltaOutput = true;
+			}
+			else if (option == "--layout" && i + 1 < argc)
+			{
+				columnLayout = geo::PointCloud::ParseColumnLayout(argv[++i]);
+			}
+			else if (option == "--huge-pages" && i + 1 < argc)
+			{
+				allocationPolicy.hugePages = mem::AllocationPolicy::ParseHugePages(argv[++i]);
+			}
+			else if (option == "--interleave")
+			{
+				allocationPolicy.isInterleaved = true;
+			}
+			else if (option == "--perf")
+			{
+				perfCounters.emplace();
+			}
+			else
+			{
+				throw std::invalid_argument("unknown option: " + option);
+			}
+		}
 
-		geo::PointCloud pointCloud = geo::PointCloud(
-			test.cloudReferencePoint,
-			test.cloudNX,
+		if (isDeltaOutput && isPartitioned)
+		{
+			throw std::invalid_argument("--delta cannot be combined with --part");
+		}
+
+		// Compile the program, unless it is already in the cache
+		io::TestInput test;
+		geo::CapsuleList capsules;
+		std::optional<io::CapsuleCache> cache;
+		if (cacheDirectory)
+		{
+			cache.emplace(*cacheDirectory, testInput, isMergingCollinear);
+		}
+		geo::SimplifyStatistics statistics;
+		if (cache && cache->Load(capsules, statistics))
+		{
+			// The program is already compiled, only the stock has to be read
+			for (const std::string& line : cache->GetSettingLines())
+			{
+				test.ParseLine(line);
+			}
+		}
+		else
+		{
+			test = io::TestInput(testInput);
+
+			// Invariants of a tool are only computed when the tool changes
+			for (const io::TestInput::Move& move : test.moves)
+			{
+				if (capsules.toolRadius.empty() || capsules.toolRadius.back() != move.sphereRadius)
+				{
+					capsules.AddTool(move.sphereRadius);
+				}
+				capsules.AddCurve(
+					*move.curve,
+					test.curveDeltaT,
+					static_cast<std::uint32_t>(capsules.toolRadius.size() - 1));
+			}
+
+			// Drop capsules, that cannot remove additional points from any cloud,
+			// before caching, so all partitions of the cloud cut the same capsules
+			statistics = capsules.Simplify(isMergingCollinear);
+			if (cache && !cache->Save(capsules, statistics))
+			{
+				std::cout << "Cannot write capsule cache, continuing without it" << std::endl;
+			}
+		}
+
+		const int partitionNX = partition.GetColumnCount(test.cloudNX);
+		if (partitionNX == 0)
+		{
+			// More partitions than columns, nothing to cut in this one
+			const io::TestOutput emptyOutput(testOutput);
+			return 0;
+		}
+
+		// The threads, that cut the cloud, also place its pages
+		if (isSegmentParallel)
+		{
+			allocationPolicy.firstTouchThreadCount = segmentThreadCount;
+		}
+
+		geo::PointCloud pointCloud(
+			partition.GetReferencePoint(test.cloudReferencePoint, test.cloudNX, test.cloudDeltaS),
+			partitionNX,
 			test.cloudNY,
 			test.cloudNZ,
-			test.cloudDeltaS);
-		
-		pointCloud.RemovePointsOnSpherePath(
-			test.sphereRadius,
-			*test.curve,
-			test.curveDeltaT);
-
-		pointCloud.CalculatePointsOnTopAndSaveToFile(testOutput);
+			test.cloudDeltaS,
+			columnLayout,
+			allocationPolicy);
+		if (allocationPolicy.hugePages != pointCloud.GetHugePages())
+		{
+			std::cout << "Requested huge pages not available, using a fallback" << std::endl;
+		}
+		if (allocationPolicy.isInterleaved && !pointCloud.IsInterleaved())
+		{
+			std::cout << "Interleaving across NUMA nodes not available, using first touch placement" << std::endl;
+		}
+
+		// Drop capsules, that cannot remove any point from this cloud
+		capsules.Cull(pointCloud.GetMinPoint(), pointCloud.GetMaxPoint(), statistics);
+		if (isPrintingStatistics)
+		{
+			std::cout << "Capsules: " << statistics.inputCount << std::endl;
+			std::cout << "  merged collinear: " << statistics.mergedCount << std::endl;
+			std::cout << "  zero length: " << statistics.zeroLengthCount << std::endl;
+			std::cout << "  above stock: " << statistics.aboveStockCount << std::endl;
+			std::cout << "  outside cloud: " << statistics.outsideCloudCount << std::endl;
+			std::cout << "  remaining: " << statistics.outputCount << std::endl;
+		}
+
+		const auto cutStart = std::chrono::steady_clock::now();
+		if (isSegmentParallel)
+		{
+			pointCloud.RemovePointsInCapsulesParallel(capsules, segmentThreadCount);
+		}
+		else
+		{
+			pointCloud.RemovePointsInCapsules(capsules);
+		}
+		const auto cutEnd = std::chrono::steady_clock::now();
+		if (!pointCloud.IsPinned())
+		{
+			std::cout << "Cannot pin threads to their cpus, pages may not be local to the threads using them" << std::endl;
+		}
+
+		// Output is not included, so the counters show the cost of the cloud layout
+		if (perfCounters)
+		{
+			std::cout << "Cutting: " << std::chrono::duration<double, std::milli>(cutEnd - cutStart).count() << "ms" << std::endl;
+			perfCounters->Print(std::cout);
+		}
+
+		if (isDeltaOutput)
+		{
+			pointCloud.CalculateChangedColumnsAndSaveToFile(testOutput);
+		}
+		else
+		{
+			pointCloud.CalculatePointsOnTopAndSaveToFile(testOutput);
+		}
 	}
 	catch (std::exception& e)
 	{
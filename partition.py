@@ -0,0 +1,63 @@
+#!/usr/bin/env python
+import os
+import sys
+import subprocess
+import time
+
+# Runs one cutSphereMove process per partition on the local machine as a stand-in for N nodes
+# and merges the partial results into the same result file a single process would produce.
+# Usage: partition.py <test_in_file> <results_file> <N> [build_dir]
+
+if len(sys.argv) < 4:
+    print('Usage: partition.py <test_in_file> <results_file> <N> [build_dir]')
+    sys.exit(1)
+
+project_folder = os.path.dirname(__file__)
+test_input_path = sys.argv[1]
+test_output_path = sys.argv[2]
+partition_count = int(sys.argv[3])
+build_dir = os.path.join(project_folder, 'build') if len(sys.argv) < 5 else os.path.abspath(sys.argv[4])
+config = 'Release'
+
+if sys.platform == "win32":
+    exe_candidates = [os.path.join(build_dir, config, 'cutSphereMove.exe'), os.path.join(build_dir, 'cutSphereMove.exe')]
+else:
+    exe_candidates = [os.path.join(build_dir, 'cutSphereMove')]
+
+cutSphereMoveExecutable = None
+for candidate in exe_candidates:
+    if os.path.isfile(candidate):
+        cutSphereMoveExecutable = candidate
+
+if cutSphereMoveExecutable is None:
+    print('ERROR: Cannot find cutSphereMove, did you forget to build?')
+    sys.exit(1)
+
+partial_output_paths = [test_output_path + '.part' + str(i) for i in range(partition_count)]
+
+start = time.time()
+children = []
+for i, partial_output_path in enumerate(partial_output_paths):
+    cmd = [cutSphereMoveExecutable, test_input_path, partial_output_path, '--part', str(i) + '/' + str(partition_count)]
+    children.append(subprocess.Popen(cmd, close_fds=(sys.platform != 'win32')))
+
+rc = 0
+for child in children:
+    child.communicate()
+    if child.returncode != 0:
+        rc = child.returncode
+end_cut = time.time()
+
+if rc != 0:
+    print('ERROR: Partition process ended with returncode=' + str(rc))
+    sys.exit(rc)
+
+rc = subprocess.call([cutSphereMoveExecutable, '--merge', test_output_path] + partial_output_paths)
+end = time.time()
+for partial_output_path in partial_output_paths:
+    os.remove(partial_output_path)
+
+print('Partitions: ' + str(partition_count))
+print('Cut time: ' + str(end_cut - start) + 's')
+print('Merge time: ' + str(end - end_cut) + 's')
+sys.exit(rc)